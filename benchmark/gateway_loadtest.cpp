@@ -0,0 +1,267 @@
+#include "../src/Gateway.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+using namespace HFT;
+using namespace std::chrono;
+
+// Loopback load test: a swarm of client connections pipelines orders into
+// the coroutine gateway, which hands them to a matching shard thread.
+//
+//   orderbook_gateway_loadtest [connections] [seconds] [pipeline depth] [trace 1/N, 0 = off]
+
+namespace {
+
+uint64_t nowNs() {
+    return duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+// Matching shard: drains the gateway ring into one book and returns results
+void runShard(CommandQueue& commands, ResponseQueue& responses, int wakeFd, MessageTracer* tracer,
+              const std::atomic<bool>& running) {
+    OrderBook book;
+    book.warmUp();
+
+    while (running.load(std::memory_order_relaxed)) {
+        size_t produced = 0;
+        while (Command* cmd = commands.front()) {
+            CommandResponse response = applyCommand(book, *cmd, tracer);
+            commands.pop();
+            while (!responses.tryPush(response)) {
+                std::this_thread::yield();
+            }
+            ++produced;
+        }
+        if (produced > 0) {
+            uint64_t one = 1;
+            ssize_t ignored = ::write(wakeFd, &one, sizeof(one));
+            (void)ignored;
+        } else {
+            std::this_thread::yield();
+        }
+    }
+}
+
+struct ClientConnection {
+    int fd = -1;
+    size_t inLength = 0;
+    char inBuffer[4096];
+    std::vector<char> outPending;    // Bytes the socket has not taken yet
+    bool wantWrite = false;          // EPOLLOUT armed
+};
+
+struct ClientResult {
+    uint64_t responses = 0;
+    std::vector<uint64_t> rttSamples;
+};
+
+// Send what is pending; a short or EAGAIN send keeps the rest (and arms
+// EPOLLOUT) so requests are never cut mid-frame
+void flushPending(int epollFd, ClientConnection& conn, uint32_t index) {
+    size_t sent = 0;
+    while (sent < conn.outPending.size()) {
+        ssize_t n = ::send(conn.fd, conn.outPending.data() + sent, conn.outPending.size() - sent, MSG_NOSIGNAL);
+        if (n > 0) {
+            sent += static_cast<size_t>(n);
+        } else if (n < 0 && errno == EINTR) {
+            continue;
+        } else {
+            break;
+        }
+    }
+    conn.outPending.erase(conn.outPending.begin(), conn.outPending.begin() + sent);
+    bool wantWrite = !conn.outPending.empty();
+    if (wantWrite != conn.wantWrite) {
+        conn.wantWrite = wantWrite;
+        epoll_event ev{};
+        ev.events = wantWrite ? uint32_t(EPOLLIN | EPOLLOUT) : uint32_t(EPOLLIN);
+        ev.data.u32 = index;
+        ::epoll_ctl(epollFd, EPOLL_CTL_MOD, conn.fd, &ev);
+    }
+}
+
+void queueRequest(ClientConnection& conn, uint64_t seq) {
+    WireRequest request{};
+    request.clientTag = nowNs();
+    request.type = CommandType::NEW_ORDER;
+    request.side = (seq & 1) ? OrderSide::BUY : OrderSide::SELL;
+    request.price = 10000 + static_cast<uint32_t>(seq % 5) - 2;
+    request.quantity = 10;
+    request.orderType = OrderType::LIMIT;
+    request.timeInForce = TimeInForce::GTC;
+    const char* bytes = reinterpret_cast<const char*>(&request);
+    conn.outPending.insert(conn.outPending.end(), bytes, bytes + sizeof(request));
+}
+
+void runClients(uint16_t port, int connections, int depth, const std::atomic<bool>& running, ClientResult& result) {
+    int epollFd = ::epoll_create1(0);
+    std::vector<ClientConnection> conns(connections);
+
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = htons(port);
+
+    uint64_t seq = 0;
+    for (int i = 0; i < connections; ++i) {
+        int fd = ::socket(AF_INET, SOCK_STREAM, 0);
+        if (::connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0) {
+            std::cerr << "connect failed\n";
+            ::close(fd);
+            continue;
+        }
+        int one = 1;
+        ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+        ::fcntl(fd, F_SETFL, ::fcntl(fd, F_GETFL) | O_NONBLOCK);
+        conns[i].fd = fd;
+
+        epoll_event ev{};
+        ev.events = EPOLLIN;
+        ev.data.u32 = static_cast<uint32_t>(i);
+        ::epoll_ctl(epollFd, EPOLL_CTL_ADD, fd, &ev);
+
+        for (int d = 0; d < depth; ++d) {
+            queueRequest(conns[i], seq++);
+        }
+        flushPending(epollFd, conns[i], static_cast<uint32_t>(i));
+    }
+
+    epoll_event events[256];
+    while (running.load(std::memory_order_relaxed)) {
+        int n = ::epoll_wait(epollFd, events, 256, 10);
+        for (int e = 0; e < n; ++e) {
+            uint32_t index = events[e].data.u32;
+            ClientConnection& conn = conns[index];
+            if (events[e].events & EPOLLOUT) {
+                flushPending(epollFd, conn, index);
+            }
+            if (!(events[e].events & EPOLLIN)) {
+                continue;
+            }
+            ssize_t r = ::recv(conn.fd, conn.inBuffer + conn.inLength, sizeof(conn.inBuffer) - conn.inLength, 0);
+            if (r <= 0) {
+                continue;
+            }
+            conn.inLength += static_cast<size_t>(r);
+
+            size_t offset = 0;
+            uint64_t now = nowNs();
+            while (conn.inLength - offset >= sizeof(WireResponse)) {
+                WireResponse response;
+                std::memcpy(&response, conn.inBuffer + offset, sizeof(response));
+                offset += sizeof(response);
+                ++result.responses;
+                if ((result.responses & 15) == 0) {
+                    result.rttSamples.push_back(now - response.clientTag);
+                }
+                queueRequest(conn, seq++);
+            }
+            std::memmove(conn.inBuffer, conn.inBuffer + offset, conn.inLength - offset);
+            conn.inLength -= offset;
+            flushPending(epollFd, conn, index);
+        }
+    }
+
+    for (auto& conn : conns) {
+        if (conn.fd >= 0) ::close(conn.fd);
+    }
+    ::close(epollFd);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    const int connections = argc > 1 ? std::atoi(argv[1]) : 1000;
+    const int seconds = argc > 2 ? std::atoi(argv[2]) : 3;
+    const int depth = argc > 3 ? std::atoi(argv[3]) : 4;
+    const int traceEvery = argc > 4 ? std::atoi(argv[4]) : 1024;
+    const int clientThreads = 2;
+
+    std::cout << "=== Gateway Load Test (loopback) ===\n";
+    std::cout << "Connections: " << connections << ", pipeline depth: " << depth
+              << ", duration: " << seconds << " s\n";
+
+    auto commands = std::make_unique<CommandQueue>();
+    auto responses = std::make_unique<ResponseQueue>();
+    GatewayReactor reactor(*commands, *responses);
+    std::unique_ptr<MessageTracer> tracer;
+    if (traceEvery > 0) {
+        tracer = std::make_unique<MessageTracer>(static_cast<uint32_t>(traceEvery));
+        reactor.setTracer(tracer.get());
+    }
+    uint16_t port = reactor.listen(0);
+    if (port == 0) {
+        std::cerr << "Failed to listen on loopback\n";
+        return 1;
+    }
+
+    std::atomic<bool> serverRunning{true};
+    std::atomic<bool> clientsRunning{true};
+    std::thread reactorThread([&] { reactor.run(serverRunning); });
+    std::thread shardThread([&] { runShard(*commands, *responses, reactor.getWakeFd(), tracer.get(), serverRunning); });
+
+    std::vector<ClientResult> results(clientThreads);
+    std::vector<std::thread> clients;
+    auto start = steady_clock::now();
+    for (int t = 0; t < clientThreads; ++t) {
+        int share = connections / clientThreads + (t < connections % clientThreads ? 1 : 0);
+        clients.emplace_back([&, t, share] { runClients(port, share, depth, clientsRunning, results[t]); });
+    }
+
+    std::this_thread::sleep_for(seconds * 1s);
+    clientsRunning.store(false);
+    for (auto& client : clients) client.join();
+    auto elapsed = duration_cast<nanoseconds>(steady_clock::now() - start).count();
+
+    serverRunning.store(false);
+    reactorThread.join();
+    shardThread.join();
+
+    uint64_t total = 0;
+    std::vector<uint64_t> rtts;
+    for (auto& r : results) {
+        total += r.responses;
+        rtts.insert(rtts.end(), r.rttSamples.begin(), r.rttSamples.end());
+    }
+    std::sort(rtts.begin(), rtts.end());
+
+    const auto& stats = reactor.getStats();
+    std::cout << "Sessions accepted: " << stats.sessionsAccepted << "\n";
+    std::cout << "Responses received: " << total << "\n";
+    std::cout << "Throughput: " << (total * 1e9 / elapsed) << " orders/second\n";
+    if (!rtts.empty()) {
+        std::cout << "Round trip P50: " << rtts[rtts.size() / 2] / 1000.0 << " us, P99: "
+                  << rtts[static_cast<size_t>(rtts.size() * 0.99)] / 1000.0 << " us\n";
+    }
+    std::cout << "Busy rejects: " << stats.busyRejects << ", malformed requests: " << stats.invalidRejects
+              << ", connections shed at the fd limit: " << stats.acceptsShed << "\n";
+    if (stats.wakeups > 0 && stats.readCalls > 0 && stats.writeCalls > 0) {
+        std::cout << "Per wakeup: " << static_cast<double>(stats.requests) / stats.wakeups << " requests, "
+                  << static_cast<double>(stats.requests) / stats.readCalls << " requests per read, "
+                  << static_cast<double>(stats.responses) / stats.writeCalls << " responses per write\n";
+    }
+
+    if (tracer && tracer->getCompletedCount() > 0) {
+        // Time spent reaching each stage from the previous stamped one
+        double ticksPerNs = measureTscTicksPerNs();
+        auto us = [&](uint64_t ticks) { return ticks / ticksPerNs / 1000.0; };
+        std::cout << "Traced messages: " << tracer->getCompletedCount() << " (1 in " << traceEvery << ")\n";
+        for (size_t stage = 1; stage < TRACE_STAGES; ++stage) {
+            const LatencyHistogram& h = tracer->getStageHistogram(static_cast<TraceStage>(stage));
+            if (h.count() == 0) {
+                continue;
+            }
+            std::cout << "  -> " << traceStageName(stage) << ": P50 " << us(h.percentile(0.5)) << " us, P99 "
+                      << us(h.percentile(0.99)) << " us\n";
+        }
+        const LatencyHistogram& total = tracer->getEndToEndHistogram();
+        std::cout << "  receive -> send: P50 " << us(total.percentile(0.5)) << " us, P99 "
+                  << us(total.percentile(0.99)) << " us\n";
+    }
+
+    return 0;
+}
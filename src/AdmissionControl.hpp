@@ -0,0 +1,195 @@
+#pragma once
+
+// Overload control in front of a book shard. Commands are split into two
+// SPSC lanes: cancels, which only ever reduce risk, and everything else
+// (new orders and modifies). The consumer always drains the cancel lane
+// first, so a burst of orders can never delay a cancel by more than one
+// command. Order-lane commands are shed instead of queued once the lane is
+// deeper than `maxOrderDepth`, and shed instead of applied once they have
+// waited longer than `maxQueueDelayNs`; either way the client gets SHED
+// and the book never sees them. Cancels are never shed. A modify can raise
+// quantity, so it gets no priority: under overload it is shed like a new
+// order.
+//
+// A cancel can only name an order the book has already accepted, so
+// letting cancels overtake queued orders cannot reorder a cancel ahead of
+// its own order. A cancel may overtake a queued modify of the same order;
+// the modify then finds the order gone, as if it had arrived later.
+//
+// Admission reorders and drops commands, so it must run before the
+// sequencer: the queue's output feeds a sequencer input (see pollInto), and
+// the journal then records exactly the stream the shard executes. Placed
+// after the sequencer, replay and replica state hashes would diverge.
+
+#include "Command.hpp"
+#include "SpscQueue.hpp"
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+namespace HFT {
+
+struct AdmissionLimits {
+    size_t maxOrderDepth = 4096;          // Order-lane commands queued before shedding
+    uint64_t maxQueueDelayNs = 50000;     // Oldest an order-lane command may be when dequeued
+};
+
+// Point-in-time copy of the counters, safe to take from any thread
+struct AdmissionStats {
+    uint64_t cancelsAdmitted;
+    uint64_t ordersAdmitted;              // New orders and modifies
+    uint64_t cancelsBusy;                 // Cancel lane full (should not happen)
+    uint64_t shedOnDepth;
+    uint64_t shedOnDelay;
+    uint64_t cancelsApplied;
+    uint64_t ordersApplied;
+    uint64_t maxQueueDelayNs;             // Worst delay seen at dequeue
+    size_t cancelDepth;
+    size_t orderDepth;
+};
+
+// Producer side: submit() from the gateway thread. Consumer side: poll() or
+// pollInto() from the thread that feeds the sequencer input for this
+// gateway. Times are caller-supplied nanoseconds on one clock, read once per
+// batch.
+template <size_t Capacity = 65536>
+class AdmissionQueue {
+private:
+    struct Entry {
+        Command command;
+        uint64_t enqueuedAt;
+    };
+
+    // Counters are single-writer; relaxed atomics so a monitor can read them
+    struct alignas(CACHE_LINE_SIZE) ProducerCounters {
+        std::atomic<uint64_t> cancelsAdmitted{0};
+        std::atomic<uint64_t> ordersAdmitted{0};
+        std::atomic<uint64_t> cancelsBusy{0};
+        std::atomic<uint64_t> shedOnDepth{0};
+    };
+
+    struct alignas(CACHE_LINE_SIZE) ConsumerCounters {
+        std::atomic<uint64_t> shedOnDelay{0};
+        std::atomic<uint64_t> cancelsApplied{0};
+        std::atomic<uint64_t> ordersApplied{0};
+        std::atomic<uint64_t> maxQueueDelayNs{0};
+    };
+
+    static void bump(std::atomic<uint64_t>& counter) {
+        counter.store(counter.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    }
+
+    std::unique_ptr<SpscQueue<Entry, Capacity>> cancelLane{new SpscQueue<Entry, Capacity>()};
+    std::unique_ptr<SpscQueue<Entry, Capacity>> orderLane{new SpscQueue<Entry, Capacity>()};
+    const AdmissionLimits limits;
+    ProducerCounters produced;
+    ConsumerCounters consumed;
+
+public:
+    explicit AdmissionQueue(const AdmissionLimits& l = AdmissionLimits()) : limits(l) {}
+
+    AdmissionQueue(const AdmissionQueue&) = delete;
+    AdmissionQueue& operator=(const AdmissionQueue&) = delete;
+
+    // Producer. ACCEPTED means queued; SHED / BUSY mean the command was
+    // dropped here and must be answered by the caller.
+    CommandStatus submit(const Command& cmd, uint64_t nowNs) {
+        if (cmd.type == CommandType::CANCEL_ORDER) {
+            Entry* slot = cancelLane->claim();
+            if (!slot) {
+                bump(produced.cancelsBusy);
+                return CommandStatus::BUSY;
+            }
+            slot->command = cmd;
+            slot->enqueuedAt = nowNs;
+            cancelLane->publish();
+            bump(produced.cancelsAdmitted);
+            return CommandStatus::ACCEPTED;
+        }
+
+        Entry* slot = orderLane->size() < limits.maxOrderDepth ? orderLane->claim() : nullptr;
+        if (!slot) {
+            bump(produced.shedOnDepth);
+            return CommandStatus::SHED;
+        }
+        slot->command = cmd;
+        slot->enqueuedAt = nowNs;
+        orderLane->publish();
+        bump(produced.ordersAdmitted);
+        return CommandStatus::ACCEPTED;
+    }
+
+    // Consumer. Hands up to `maxBatch` commands to `apply`, cancel lane
+    // first; order-lane commands that waited too long go to `shed` instead
+    // (it gets the command and should answer it with SHED). Returns
+    // commands taken.
+    template <typename Apply, typename Shed>
+    size_t poll(uint64_t nowNs, Apply&& apply, Shed&& shed, size_t maxBatch = 256) {
+        return drain(nowNs, [&](const Command& cmd) { apply(cmd); return true; }, shed, maxBatch);
+    }
+
+    // Consumer, forwarding admitted commands into a sequencer input ring.
+    // Stops early (leaving the command queued) when `out` is full.
+    template <typename Shed>
+    size_t pollInto(uint64_t nowNs, CommandQueue& out, Shed&& shed, size_t maxBatch = 256) {
+        return drain(nowNs, [&](const Command& cmd) { return out.tryPush(cmd); }, shed, maxBatch);
+    }
+
+    const AdmissionLimits& getLimits() const { return limits; }
+
+    size_t getCancelDepth() const { return cancelLane->size(); }
+    size_t getOrderDepth() const { return orderLane->size(); }
+
+    AdmissionStats getStats() const {
+        return {produced.cancelsAdmitted.load(std::memory_order_relaxed),
+                produced.ordersAdmitted.load(std::memory_order_relaxed),
+                produced.cancelsBusy.load(std::memory_order_relaxed),
+                produced.shedOnDepth.load(std::memory_order_relaxed),
+                consumed.shedOnDelay.load(std::memory_order_relaxed),
+                consumed.cancelsApplied.load(std::memory_order_relaxed),
+                consumed.ordersApplied.load(std::memory_order_relaxed),
+                consumed.maxQueueDelayNs.load(std::memory_order_relaxed),
+                getCancelDepth(),
+                getOrderDepth()};
+    }
+
+private:
+    // `apply` returns false to stop with the command left queued
+    template <typename Apply, typename Shed>
+    size_t drain(uint64_t nowNs, Apply&& apply, Shed&& shed, size_t maxBatch) {
+        size_t taken = 0;
+        uint64_t worstDelay = consumed.maxQueueDelayNs.load(std::memory_order_relaxed);
+        while (taken < maxBatch) {
+            // Re-check cancels before every order-lane command
+            if (Entry* entry = cancelLane->front()) {
+                if (!apply(entry->command)) {
+                    break;
+                }
+                cancelLane->pop();
+                bump(consumed.cancelsApplied);
+                ++taken;
+                continue;
+            }
+            Entry* entry = orderLane->front();
+            if (!entry) {
+                break;
+            }
+            uint64_t delay = nowNs > entry->enqueuedAt ? nowNs - entry->enqueuedAt : 0;
+            worstDelay = delay > worstDelay ? delay : worstDelay;
+            if (delay > limits.maxQueueDelayNs) {
+                shed(entry->command);
+                bump(consumed.shedOnDelay);
+            } else if (apply(entry->command)) {
+                bump(consumed.ordersApplied);
+            } else {
+                break;
+            }
+            orderLane->pop();
+            ++taken;
+        }
+        consumed.maxQueueDelayNs.store(worstDelay, std::memory_order_relaxed);
+        return taken;
+    }
+};
+
+} // namespace HFT
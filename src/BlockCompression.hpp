@@ -0,0 +1,426 @@
+#pragma once
+
+// Block-compressed files of fixed-size records.
+//
+//   BlockFileHeader, then per block a BlockFrameHeader and its payload
+//
+// Each block is optionally delta-transformed and then LZ-compressed. The
+// transform replaces every 8-byte word with its zigzag-coded difference
+// from the same word of the previous record, so sequence numbers,
+// timestamps, IDs and prices collapse to small values, then groups byte k
+// of every record together so their zero high bytes form long runs.
+// The writer only copies records into a block buffer on the caller's
+// thread; transform, compression and file I/O run on its own I/O thread.
+
+#include "Lz.hpp"
+#include "SpscQueue.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace HFT {
+
+struct BlockFileHeader {
+    char magic[8];
+    uint32_t recordSize;
+    uint32_t blockRecords;
+    uint32_t flags;
+    uint32_t reserved;
+};
+
+struct BlockFrameHeader {
+    uint32_t records;
+    uint32_t compressedBytes;
+    uint64_t firstRecord;    // Index of the block's first record in the file
+    uint64_t firstKey;       // Caller-supplied key of that record (e.g. time)
+};
+
+namespace BlockFormat {
+constexpr uint32_t FLAG_DELTA = 1;
+} // namespace BlockFormat
+
+// Needs recordSize % 8 == 0. Records are processed eight at a time so each
+// byte plane is read or written a whole word at a time; an 8x8 byte
+// transpose moves between the two layouts.
+namespace DeltaTransform {
+
+// Byte m of x[j] <-> byte j of x[m]
+inline void transpose8x8(uint64_t x[8]) {
+    for (int i = 0; i < 4; ++i) {
+        uint64_t t = ((x[i] >> 32) ^ x[i + 4]) & 0x00000000FFFFFFFFull;
+        x[i] ^= t << 32;
+        x[i + 4] ^= t;
+    }
+    for (int i : {0, 1, 4, 5}) {
+        uint64_t t = ((x[i] >> 16) ^ x[i + 2]) & 0x0000FFFF0000FFFFull;
+        x[i] ^= t << 16;
+        x[i + 2] ^= t;
+    }
+    for (int i = 0; i < 8; i += 2) {
+        uint64_t t = ((x[i] >> 8) ^ x[i + 1]) & 0x00FF00FF00FF00FFull;
+        x[i] ^= t << 8;
+        x[i + 1] ^= t;
+    }
+}
+
+inline uint64_t zigzag(uint64_t d) {
+    return (d << 1) ^ static_cast<uint64_t>(static_cast<int64_t>(d) >> 63);
+}
+
+inline uint64_t unzigzag(uint64_t z) {
+    return (z >> 1) ^ (0 - (z & 1));
+}
+
+inline void encode(const uint8_t* data, uint8_t* out, size_t records, size_t recordSize) {
+    const size_t words = recordSize / sizeof(uint64_t);
+    const auto* w = reinterpret_cast<const uint64_t*>(data);
+    auto delta = [&](size_t r, size_t k) {
+        size_t i = r * words + k;
+        return zigzag(w[i] - (r > 0 ? w[i - words] : 0));
+    };
+
+    size_t r = 0;
+    for (; r + 8 <= records; r += 8) {
+        for (size_t k = 0; k < words; ++k) {
+            uint64_t x[8];
+            for (size_t m = 0; m < 8; ++m) {
+                x[m] = delta(r + m, k);
+            }
+            transpose8x8(x);
+            for (size_t j = 0; j < 8; ++j) {
+                std::memcpy(out + (k * 8 + j) * records + r, &x[j], 8);
+            }
+        }
+    }
+    for (; r < records; ++r) {
+        for (size_t k = 0; k < words; ++k) {
+            uint64_t z = delta(r, k);
+            for (size_t j = 0; j < 8; ++j) {
+                out[(k * 8 + j) * records + r] = static_cast<uint8_t>(z >> (8 * j));
+            }
+        }
+    }
+}
+
+inline void decode(const uint8_t* in, uint8_t* data, size_t records, size_t recordSize) {
+    const size_t words = recordSize / sizeof(uint64_t);
+    auto* w = reinterpret_cast<uint64_t*>(data);
+    auto store = [&](size_t r, size_t k, uint64_t z) {
+        size_t i = r * words + k;
+        w[i] = (r > 0 ? w[i - words] : 0) + unzigzag(z);
+    };
+
+    size_t r = 0;
+    for (; r + 8 <= records; r += 8) {
+        for (size_t k = 0; k < words; ++k) {
+            uint64_t x[8];
+            for (size_t j = 0; j < 8; ++j) {
+                std::memcpy(&x[j], in + (k * 8 + j) * records + r, 8);
+            }
+            transpose8x8(x);
+            for (size_t m = 0; m < 8; ++m) {
+                store(r + m, k, x[m]);
+            }
+        }
+    }
+    for (; r < records; ++r) {
+        for (size_t k = 0; k < words; ++k) {
+            uint64_t z = 0;
+            for (size_t j = 0; j < 8; ++j) {
+                z |= static_cast<uint64_t>(in[(k * 8 + j) * records + r]) << (8 * j);
+            }
+            store(r, k, z);
+        }
+    }
+}
+
+} // namespace DeltaTransform
+
+class CompressedBlockWriter {
+private:
+    struct Block {
+        std::unique_ptr<uint8_t[]> data;
+        uint32_t records = 0;
+        uint64_t firstRecord = 0;
+        uint64_t firstKey = 0;
+    };
+
+    static constexpr size_t POOL_BLOCKS = 8;
+
+    FILE* file = nullptr;
+    uint32_t recordSize = 0;
+    uint32_t blockRecords = 0;
+    uint32_t flags = 0;
+
+    Block pool[POOL_BLOCKS];
+    std::unique_ptr<SpscQueue<Block*, 16>> fullBlocks;
+    std::unique_ptr<SpscQueue<Block*, 16>> freeBlocks;
+    Block* current = nullptr;
+    uint64_t recordCount = 0;
+    uint64_t poolStalls = 0;
+
+    // I/O thread state
+    std::thread ioThread;
+    std::atomic<bool> running{false};
+    std::unique_ptr<uint8_t[]> transformed;
+    std::unique_ptr<uint8_t[]> compressed;
+    std::unique_ptr<uint32_t[]> matchTable{new uint32_t[Lz::HASH_ENTRIES]};
+    uint64_t bytesWritten = 0;
+
+public:
+    CompressedBlockWriter() = default;
+    CompressedBlockWriter(const CompressedBlockWriter&) = delete;
+    CompressedBlockWriter& operator=(const CompressedBlockWriter&) = delete;
+    ~CompressedBlockWriter() { close(); }
+
+    bool open(const std::string& path, const char (&magic)[8], uint32_t bytesPerRecord,
+              uint32_t recordsPerBlock = 4096, bool deltaTransform = true) {
+        if (file) {
+            return false;
+        }
+        file = std::fopen(path.c_str(), "wb");
+        if (!file) {
+            return false;
+        }
+        recordSize = bytesPerRecord;
+        blockRecords = recordsPerBlock;
+        flags = (deltaTransform && recordSize % sizeof(uint64_t) == 0) ? BlockFormat::FLAG_DELTA : 0;
+
+        BlockFileHeader header{};
+        std::memcpy(header.magic, magic, sizeof(header.magic));
+        header.recordSize = recordSize;
+        header.blockRecords = blockRecords;
+        header.flags = flags;
+        std::fwrite(&header, sizeof(header), 1, file);
+        bytesWritten = sizeof(header);
+
+        // Fresh queues: blocks the I/O thread handed back in a previous
+        // session must not be queued twice
+        fullBlocks = std::make_unique<SpscQueue<Block*, 16>>();
+        freeBlocks = std::make_unique<SpscQueue<Block*, 16>>();
+        size_t blockBytes = size_t(recordSize) * blockRecords;
+        for (Block& block : pool) {
+            block.data.reset(new uint8_t[blockBytes]);
+            block.records = 0;
+            freeBlocks->tryPush(&block);
+        }
+        transformed.reset(new uint8_t[blockBytes]);
+        compressed.reset(new uint8_t[Lz::compressBound(blockBytes)]);
+        current = nullptr;
+        recordCount = 0;
+        poolStalls = 0;
+
+        running.store(true, std::memory_order_release);
+        ioThread = std::thread([this] { ioLoop(); });
+        return true;
+    }
+
+    bool isOpen() const { return file != nullptr; }
+
+    // Caller thread: one record copy. Waits only if every pooled block is
+    // still queued for the I/O thread.
+    void append(const void* record, uint64_t key) {
+        if (!current) {
+            while (!freeBlocks->tryPop(current)) {
+                ++poolStalls;
+                std::this_thread::yield();
+            }
+            current->records = 0;
+            current->firstRecord = recordCount;
+            current->firstKey = key;
+        }
+        std::memcpy(current->data.get() + size_t(current->records) * recordSize, record, recordSize);
+        ++recordCount;
+        if (++current->records == blockRecords) {
+            fullBlocks->tryPush(current);
+            current = nullptr;
+        }
+    }
+
+    // Write the partial block, drain the I/O thread and close the file
+    void close() {
+        if (!file) {
+            return;
+        }
+        if (current && current->records > 0) {
+            fullBlocks->tryPush(current);
+        }
+        current = nullptr;
+        running.store(false, std::memory_order_release);
+        ioThread.join();
+        std::fclose(file);
+        file = nullptr;
+    }
+
+    uint64_t getRecordCount() const { return recordCount; }
+    uint64_t getPoolStalls() const { return poolStalls; }
+
+    // Valid after close()
+    uint64_t getRawBytes() const { return sizeof(BlockFileHeader) + recordCount * recordSize; }
+    uint64_t getBytesWritten() const { return bytesWritten; }
+
+private:
+    void ioLoop() {
+        for (;;) {
+            bool stopping = !running.load(std::memory_order_acquire);
+            Block* block = nullptr;
+            if (fullBlocks->tryPop(block)) {
+                writeBlock(*block);
+                freeBlocks->tryPush(block);
+                continue;
+            }
+            if (stopping) {
+                std::fflush(file);
+                return;
+            }
+            std::this_thread::sleep_for(std::chrono::microseconds(50));
+        }
+    }
+
+    void writeBlock(Block& block) {
+        size_t rawBytes = size_t(block.records) * recordSize;
+        const uint8_t* input = block.data.get();
+        if (flags & BlockFormat::FLAG_DELTA) {
+            DeltaTransform::encode(block.data.get(), transformed.get(), block.records, recordSize);
+            input = transformed.get();
+        }
+        size_t n = Lz::compress(input, rawBytes, compressed.get(), Lz::compressBound(rawBytes), matchTable.get());
+
+        BlockFrameHeader frame{block.records, static_cast<uint32_t>(n), block.firstRecord, block.firstKey};
+        std::fwrite(&frame, sizeof(frame), 1, file);
+        std::fwrite(compressed.get(), 1, n, file);
+        bytesWritten += sizeof(frame) + n;
+    }
+};
+
+// Random-access reader. open() hops the frame headers once to build the
+// block index; readBlock() decodes one block into an internal buffer.
+class CompressedBlockReader {
+public:
+    struct BlockEntry {
+        long offset;         // Payload offset in the file
+        uint32_t records;
+        uint32_t compressedBytes;
+        uint64_t firstRecord;
+        uint64_t firstKey;
+    };
+
+private:
+    FILE* file = nullptr;
+    BlockFileHeader header{};
+    std::vector<BlockEntry> blocks;
+    uint64_t recordCount = 0;
+    std::unique_ptr<uint8_t[]> compressed;
+    std::unique_ptr<uint8_t[]> transformed;
+    std::unique_ptr<uint8_t[]> decoded;
+    size_t decodedBlock = SIZE_MAX;
+
+public:
+    CompressedBlockReader() = default;
+    CompressedBlockReader(const CompressedBlockReader&) = delete;
+    CompressedBlockReader& operator=(const CompressedBlockReader&) = delete;
+    ~CompressedBlockReader() { close(); }
+
+    bool open(const std::string& path, const char (&magic)[8]) {
+        close();
+        file = std::fopen(path.c_str(), "rb");
+        if (!file) {
+            return false;
+        }
+        if (std::fread(&header, sizeof(header), 1, file) != 1 ||
+            std::memcmp(header.magic, magic, sizeof(header.magic)) != 0 ||
+            header.recordSize == 0 || header.blockRecords == 0) {
+            close();
+            return false;
+        }
+
+        size_t blockBytes = size_t(header.recordSize) * header.blockRecords;
+        size_t maxCompressed = Lz::compressBound(blockBytes);
+        long offset = static_cast<long>(sizeof(header));
+        BlockFrameHeader frame;
+        // A truncated trailing frame is ignored
+        while (std::fread(&frame, sizeof(frame), 1, file) == 1) {
+            offset += static_cast<long>(sizeof(frame));
+            if (frame.records == 0 || frame.records > header.blockRecords || frame.compressedBytes > maxCompressed ||
+                std::fseek(file, static_cast<long>(frame.compressedBytes), SEEK_CUR) != 0) {
+                break;
+            }
+            blocks.push_back({offset, frame.records, frame.compressedBytes, frame.firstRecord, frame.firstKey});
+            offset += static_cast<long>(frame.compressedBytes);
+            recordCount = frame.firstRecord + frame.records;
+        }
+        std::fseek(file, 0, SEEK_END);
+        if (std::ftell(file) < offset && !blocks.empty()) {
+            recordCount -= blocks.back().records;
+            blocks.pop_back();
+        }
+
+        compressed.reset(new uint8_t[maxCompressed]);
+        transformed.reset(new uint8_t[blockBytes]);
+        decoded.reset(new uint8_t[blockBytes]);
+        return true;
+    }
+
+    void close() {
+        if (file) {
+            std::fclose(file);
+            file = nullptr;
+        }
+        blocks.clear();
+        recordCount = 0;
+        decodedBlock = SIZE_MAX;
+    }
+
+    uint32_t getRecordSize() const { return header.recordSize; }
+    uint64_t getRecordCount() const { return recordCount; }
+    size_t getBlockCount() const { return blocks.size(); }
+    const BlockEntry& getBlock(size_t index) const { return blocks[index]; }
+
+    // Decoded records of block `index`, valid until the next call; nullptr
+    // if the block is corrupt
+    const uint8_t* readBlock(size_t index) {
+        if (index == decodedBlock) {
+            return decoded.get();
+        }
+        const BlockEntry& entry = blocks[index];
+        size_t rawBytes = size_t(entry.records) * header.recordSize;
+        bool delta = (header.flags & BlockFormat::FLAG_DELTA) != 0;
+        uint8_t* target = delta ? transformed.get() : decoded.get();
+        if (std::fseek(file, entry.offset, SEEK_SET) != 0 ||
+            std::fread(compressed.get(), 1, entry.compressedBytes, file) != entry.compressedBytes ||
+            Lz::decompress(compressed.get(), entry.compressedBytes, target, rawBytes) != rawBytes) {
+            decodedBlock = SIZE_MAX;
+            return nullptr;
+        }
+        if (delta) {
+            DeltaTransform::decode(transformed.get(), decoded.get(), entry.records, header.recordSize);
+        }
+        decodedBlock = index;
+        return decoded.get();
+    }
+
+    // Block holding record `record` (blocks.size() if past the end)
+    size_t findRecord(uint64_t record) const {
+        auto it = std::upper_bound(blocks.begin(), blocks.end(), record,
+            [](uint64_t r, const BlockEntry& entry) { return r < entry.firstRecord; });
+        if (it == blocks.begin() || record >= recordCount) {
+            return blocks.size();
+        }
+        return static_cast<size_t>(it - blocks.begin()) - 1;
+    }
+
+    // First block whose first key is >= key
+    size_t lowerBoundKey(uint64_t key) const {
+        auto it = std::lower_bound(blocks.begin(), blocks.end(), key,
+            [](const BlockEntry& entry, uint64_t k) { return entry.firstKey < k; });
+        return static_cast<size_t>(it - blocks.begin());
+    }
+};
+
+} // namespace HFT
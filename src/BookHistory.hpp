@@ -0,0 +1,293 @@
+#pragma once
+
+// Point-in-time book history: periodic full snapshots plus the sequenced
+// command stream in between (POSIX).
+//
+//   <path>.snap     SNAPSHOT_MAGIC, then per snapshot a BookSnapshotHeader
+//                   followed by `orderCount` raw Order records
+//   <path>.journal  standard command journal (see Journal.hpp) holding the
+//                   deltas, raw or block-compressed
+//
+// Matching is deterministic, so the book at time T is the last snapshot at
+// or before T plus the commands between it and T.
+
+#include "Command.hpp"
+#include "Journal.hpp"
+#include "MappedFile.hpp"
+#include "SpscQueue.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace HFT {
+
+struct BookSnapshotHeader {
+    uint64_t timestamp;      // Taken before the first command at this time
+    uint64_t deltaIndex;     // Commands journaled before the snapshot
+    uint64_t nextSequence;   // Order ID generator position
+    uint64_t orderCount;
+};
+
+namespace BookHistoryFormat {
+constexpr char SNAPSHOT_MAGIC[8] = {'H', 'F', 'T', 'S', 'N', 'A', 'P', '2'};   // 2: Order gained handleSlot
+} // namespace BookHistoryFormat
+
+// Engine-side writer. record() snapshots the book when the interval has
+// elapsed, journals the command and applies it. A snapshot is only copied
+// into a preallocated buffer on the engine thread; an I/O thread writes it
+// out. If both buffers are still being written the snapshot is deferred to
+// the next command. Deltas are likewise only copied: the JournalWriter
+// writes (or compresses) them on its own I/O thread.
+class BookHistoryWriter {
+private:
+    struct SnapshotBuffer {
+        BookSnapshotHeader header;
+        std::vector<Order> orders;
+    };
+
+    static constexpr size_t SNAPSHOT_BUFFERS = 2;
+    using SnapshotQueue = SpscQueue<SnapshotBuffer*, 4>;
+
+    FILE* snapshotFile = nullptr;
+    JournalWriter deltas;
+    SnapshotBuffer buffers[SNAPSHOT_BUFFERS];
+    std::unique_ptr<SnapshotQueue> fullSnapshots;
+    std::unique_ptr<SnapshotQueue> freeSnapshots;
+    uint64_t snapshotInterval = 0;
+    uint64_t nextSnapshotAt = 0;
+    uint64_t deltaCount = 0;
+    uint64_t snapshotCount = 0;
+    uint64_t snapshotsDeferred = 0;
+
+    // I/O thread state
+    std::thread ioThread;
+    std::atomic<bool> running{false};
+
+public:
+    BookHistoryWriter() = default;
+    BookHistoryWriter(const BookHistoryWriter&) = delete;
+    BookHistoryWriter& operator=(const BookHistoryWriter&) = delete;
+    ~BookHistoryWriter() { close(); }
+
+    // False if already open
+    bool open(const std::string& path, uint64_t snapshotIntervalNs, bool compressDeltas = false) {
+        if (snapshotFile) {
+            return false;
+        }
+        snapshotFile = std::fopen((path + ".snap").c_str(), "wb");
+        if (!snapshotFile || !deltas.open(path + ".journal", compressDeltas)) {
+            close();
+            return false;
+        }
+        std::fwrite(BookHistoryFormat::SNAPSHOT_MAGIC, 1, sizeof(BookHistoryFormat::SNAPSHOT_MAGIC), snapshotFile);
+        snapshotInterval = snapshotIntervalNs;
+        nextSnapshotAt = 0;
+        deltaCount = 0;
+        snapshotCount = 0;
+        snapshotsDeferred = 0;
+
+        // Fresh queues: nothing handed back by a previous session survives
+        fullSnapshots = std::make_unique<SnapshotQueue>();
+        freeSnapshots = std::make_unique<SnapshotQueue>();
+        for (SnapshotBuffer& buffer : buffers) {
+            freeSnapshots->tryPush(&buffer);
+        }
+        running.store(true, std::memory_order_release);
+        ioThread = std::thread([this] { ioLoop(); });
+        return true;
+    }
+
+    CommandResponse record(OrderBook& book, const Command& cmd) {
+        if (cmd.timestamp >= nextSnapshotAt) {
+            writeSnapshot(book, cmd.timestamp);
+        }
+        deltas.append(cmd);
+        ++deltaCount;
+        return applyCommand(book, cmd);
+    }
+
+    // Snapshot now, regardless of the interval. False if no buffer is free
+    // (the I/O thread is behind); the next record() tries again.
+    bool writeSnapshot(const OrderBook& book, uint64_t timestamp) {
+        SnapshotBuffer* buffer = nullptr;
+        if (!freeSnapshots->tryPop(buffer)) {
+            ++snapshotsDeferred;
+            return false;
+        }
+        book.captureSnapshot(buffer->orders);
+        buffer->header = {timestamp, deltaCount, book.getNextOrderSequence(), buffer->orders.size()};
+        fullSnapshots->tryPush(buffer);
+        nextSnapshotAt = timestamp + snapshotInterval;
+        ++snapshotCount;
+        return true;
+    }
+
+    // Drain queued snapshots and close both files
+    void close() {
+        if (ioThread.joinable()) {
+            running.store(false, std::memory_order_release);
+            ioThread.join();
+        }
+        if (snapshotFile) {
+            std::fclose(snapshotFile);
+            snapshotFile = nullptr;
+        }
+        deltas.close();
+    }
+
+    uint64_t getSnapshotCount() const { return snapshotCount; }
+    uint64_t getSnapshotsDeferred() const { return snapshotsDeferred; }
+    uint64_t getDeltaCount() const { return deltaCount; }
+
+private:
+    void ioLoop() {
+        for (;;) {
+            bool stopping = !running.load(std::memory_order_acquire);
+            SnapshotBuffer* buffer = nullptr;
+            if (fullSnapshots->tryPop(buffer)) {
+                std::fwrite(&buffer->header, sizeof(buffer->header), 1, snapshotFile);
+                std::fwrite(buffer->orders.data(), sizeof(Order), buffer->orders.size(), snapshotFile);
+                freeSnapshots->tryPush(buffer);
+                continue;
+            }
+            if (stopping) {
+                std::fflush(snapshotFile);
+                return;
+            }
+            std::this_thread::sleep_for(std::chrono::microseconds(200));
+        }
+    }
+};
+
+// Result of a point-in-time query
+struct ReconstructResult {
+    bool found;
+    uint64_t snapshotTimestamp;
+    uint64_t deltasApplied;
+};
+
+// Maps both files and keeps an in-memory time index of the snapshots.
+// reconstructAt() binary-searches it, restores one snapshot and replays
+// only the commands after it. Compressed deltas are decoded block by block
+// starting at the block that holds the snapshot's first delta.
+class BookHistoryReader {
+private:
+    struct SnapshotEntry {
+        uint64_t timestamp;
+        uint64_t deltaIndex;
+        uint64_t nextSequence;
+        uint64_t orderCount;
+        const Order* orders;
+    };
+
+    MappedFile snapshotFile;
+    MappedFile deltaFile;
+    CompressedBlockReader compressedDeltas;
+    bool deltasCompressed = false;
+    std::vector<SnapshotEntry> snapshots;
+    const Command* commands = nullptr;
+    uint64_t commandCount = 0;
+
+public:
+    bool open(const std::string& path) {
+        if (!snapshotFile.open(path + ".snap", false) || !deltaFile.open(path + ".journal", false)) {
+            return false;
+        }
+        constexpr size_t magicSize = sizeof(BookHistoryFormat::SNAPSHOT_MAGIC);
+        if (snapshotFile.size() < magicSize || deltaFile.size() < sizeof(JournalFormat::MAGIC) ||
+            std::memcmp(snapshotFile.data(), BookHistoryFormat::SNAPSHOT_MAGIC, magicSize) != 0) {
+            return false;
+        }
+
+        deltasCompressed = std::memcmp(deltaFile.data(), JournalFormat::COMPRESSED_MAGIC,
+                                       sizeof(JournalFormat::COMPRESSED_MAGIC)) == 0;
+        if (deltasCompressed) {
+            deltaFile.close();
+            if (!compressedDeltas.open(path + ".journal", JournalFormat::COMPRESSED_MAGIC) ||
+                compressedDeltas.getRecordSize() != sizeof(Command)) {
+                return false;
+            }
+            commands = nullptr;
+            commandCount = compressedDeltas.getRecordCount();
+        } else if (std::memcmp(deltaFile.data(), JournalFormat::MAGIC, sizeof(JournalFormat::MAGIC)) == 0) {
+            commands = reinterpret_cast<const Command*>(deltaFile.data() + sizeof(JournalFormat::MAGIC));
+            commandCount = (deltaFile.size() - sizeof(JournalFormat::MAGIC)) / sizeof(Command);
+        } else {
+            return false;
+        }
+
+        // Hop header to header; a truncated trailing snapshot is ignored
+        snapshots.clear();
+        size_t offset = magicSize;
+        while (offset + sizeof(BookSnapshotHeader) <= snapshotFile.size()) {
+            BookSnapshotHeader header;
+            std::memcpy(&header, snapshotFile.data() + offset, sizeof(header));
+            size_t body = header.orderCount * sizeof(Order);
+            offset += sizeof(header);
+            if (offset + body > snapshotFile.size() || header.deltaIndex > commandCount) {
+                break;
+            }
+            snapshots.push_back({header.timestamp, header.deltaIndex, header.nextSequence, header.orderCount,
+                                 reinterpret_cast<const Order*>(snapshotFile.data() + offset)});
+            offset += body;
+        }
+        return true;
+    }
+
+    size_t getSnapshotCount() const { return snapshots.size(); }
+    uint64_t getDeltaCount() const { return commandCount; }
+
+    // Rebuild `book` as it stood after every recorded command with
+    // timestamp <= `timestamp`. The book must have the same shard / book
+    // ID as the recorded one.
+    ReconstructResult reconstructAt(uint64_t timestamp, OrderBook& book) {
+        auto it = std::upper_bound(snapshots.begin(), snapshots.end(), timestamp,
+            [](uint64_t ts, const SnapshotEntry& entry) { return ts < entry.timestamp; });
+        if (it == snapshots.begin()) {
+            return {false, 0, 0};
+        }
+        const SnapshotEntry& snapshot = *(it - 1);
+        book.restoreSnapshot(snapshot.orders, snapshot.orderCount, snapshot.nextSequence);
+
+        uint64_t applied = deltasCompressed ? replayCompressed(snapshot.deltaIndex, timestamp, book)
+                                            : replayMapped(snapshot.deltaIndex, timestamp, book);
+        return {true, snapshot.timestamp, applied};
+    }
+
+private:
+    uint64_t replayMapped(uint64_t first, uint64_t timestamp, OrderBook& book) const {
+        uint64_t index = first;
+        while (index < commandCount && commands[index].timestamp <= timestamp) {
+            applyCommand(book, commands[index]);
+            ++index;
+        }
+        return index - first;
+    }
+
+    uint64_t replayCompressed(uint64_t first, uint64_t timestamp, OrderBook& book) {
+        uint64_t applied = 0;
+        for (size_t b = compressedDeltas.findRecord(first); b < compressedDeltas.getBlockCount(); ++b) {
+            const auto* block = reinterpret_cast<const Command*>(compressedDeltas.readBlock(b));
+            if (!block) {
+                break;
+            }
+            const auto& entry = compressedDeltas.getBlock(b);
+            for (uint64_t i = first > entry.firstRecord ? first - entry.firstRecord : 0; i < entry.records; ++i) {
+                if (block[i].timestamp > timestamp) {
+                    return applied;
+                }
+                applyCommand(book, block[i]);
+                ++applied;
+            }
+        }
+        return applied;
+    }
+};
+
+} // namespace HFT
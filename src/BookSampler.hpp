@@ -0,0 +1,338 @@
+#pragma once
+
+// Book-state sampler for research datasets: top-N depth of each book on a
+// timer and after every order that traded, written to a columnar file.
+//
+// On the engine thread a sample is one fixed-size row copied into a
+// preallocated batch: a 16-byte row header plus N price / quantity pairs
+// per side, filled straight from the book's levels. There is no formatting
+// or allocation, and no waiting: if every batch is still queued for the
+// I/O thread the sample is dropped and counted. The I/O thread turns each
+// full batch into columns and appends it to the file.
+//
+//   SampleFileHeader, then per batch a SampleBatchHeader followed by
+//   columns of `rows` values each, in this order:
+//     timestamp (u64), instrument, trigger, bidLevels, askLevels,
+//     bidPrice[0..N), bidQuantity[0..N), askPrice[0..N), askQuantity[0..N)
+//   all u32 after the timestamp. Unused levels are 0.
+
+#include "Order.hpp"
+#include "SpscQueue.hpp"
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace HFT {
+
+enum class SampleTrigger : uint8_t {
+    TIMER = 0,
+    TRADE = 1
+};
+
+struct SampleFileHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t depth;          // Levels per side
+    uint32_t columns;        // u32 columns after the timestamp column
+    uint32_t batchRows;      // Rows in a full batch
+};
+
+struct SampleBatchHeader {
+    uint32_t rows;
+    uint32_t reserved;
+    uint64_t firstTimestamp;
+    uint64_t lastTimestamp;
+};
+
+namespace SampleFormat {
+constexpr char MAGIC[8] = {'H', 'F', 'T', 'S', 'A', 'M', 'P', '1'};
+constexpr uint32_t VERSION = 1;
+constexpr uint32_t MAX_DEPTH = 64;
+
+// u32 column indices after the timestamp
+constexpr uint32_t INSTRUMENT = 0;
+constexpr uint32_t TRIGGER = 1;
+constexpr uint32_t BID_LEVELS = 2;
+constexpr uint32_t ASK_LEVELS = 3;
+constexpr uint32_t FIRST_LEVEL = 4;
+
+inline uint32_t columnCount(uint32_t depth) { return FIRST_LEVEL + 4 * depth; }
+inline uint32_t bidPrice(uint32_t, uint32_t level) { return FIRST_LEVEL + level; }
+inline uint32_t bidQuantity(uint32_t depth, uint32_t level) { return FIRST_LEVEL + depth + level; }
+inline uint32_t askPrice(uint32_t depth, uint32_t level) { return FIRST_LEVEL + 2 * depth + level; }
+inline uint32_t askQuantity(uint32_t depth, uint32_t level) { return FIRST_LEVEL + 3 * depth + level; }
+} // namespace SampleFormat
+
+// Engine side: one producer thread (the thread driving the books it
+// samples). Books call sample() themselves on trades once attached (see
+// OrderBook::attachSampler); the timer is polled by the engine loop.
+class BookSampler {
+private:
+    struct RowHeader {
+        uint64_t timestamp;
+        uint32_t instrumentId;
+        uint8_t trigger;
+        uint8_t bidLevels;
+        uint8_t askLevels;
+        uint8_t reserved;
+    };
+
+    struct Batch {
+        std::unique_ptr<uint8_t[]> rows;
+        uint32_t count = 0;
+    };
+
+    static constexpr size_t POOL_BATCHES = 8;
+
+    FILE* file = nullptr;
+    uint32_t depth = 0;
+    uint32_t batchRows = 0;
+    size_t rowSize = 0;
+    size_t columnarRowSize = 0;   // Row header fields widen to u32 columns
+
+    Batch pool[POOL_BATCHES];
+    std::unique_ptr<SpscQueue<Batch*, 16>> fullBatches = std::make_unique<SpscQueue<Batch*, 16>>();
+    std::unique_ptr<SpscQueue<Batch*, 16>> freeBatches = std::make_unique<SpscQueue<Batch*, 16>>();
+    Batch* current = nullptr;
+    uint64_t intervalNs = 0;
+    uint64_t nextTimerNs = 0;
+    uint64_t samples = 0;
+    uint64_t dropped = 0;
+
+    // I/O thread state
+    std::thread ioThread;
+    std::atomic<bool> running{false};
+    std::unique_ptr<uint8_t[]> columns;
+    uint64_t batchesWritten = 0;
+
+public:
+    BookSampler() = default;
+    BookSampler(const BookSampler&) = delete;
+    BookSampler& operator=(const BookSampler&) = delete;
+    ~BookSampler() { close(); }
+
+    // Sample `levels` per side, every `periodNs` on the timer (0 = trades
+    // only), in batches of `rowsPerBatch`. False if already open.
+    bool open(const std::string& path, uint32_t levels = 10, uint64_t periodNs = 100000000,
+              uint32_t rowsPerBatch = 4096) {
+        if (file || levels == 0 || levels > SampleFormat::MAX_DEPTH || rowsPerBatch == 0) {
+            return false;
+        }
+        file = std::fopen(path.c_str(), "wb");
+        if (!file) {
+            return false;
+        }
+        depth = levels;
+        batchRows = rowsPerBatch;
+        rowSize = sizeof(RowHeader) + 4 * size_t(depth) * sizeof(uint32_t);
+        columnarRowSize = sizeof(uint64_t) + SampleFormat::columnCount(depth) * sizeof(uint32_t);
+        intervalNs = periodNs;
+        nextTimerNs = 0;
+
+        SampleFileHeader header{};
+        std::memcpy(header.magic, SampleFormat::MAGIC, sizeof(header.magic));
+        header.version = SampleFormat::VERSION;
+        header.depth = depth;
+        header.columns = SampleFormat::columnCount(depth);
+        header.batchRows = batchRows;
+        std::fwrite(&header, sizeof(header), 1, file);
+
+        // Fresh queues: a previous session leaves its batches on the free
+        // queue. Touch every buffer now so the first samples do not
+        // page-fault.
+        fullBatches = std::make_unique<SpscQueue<Batch*, 16>>();
+        freeBatches = std::make_unique<SpscQueue<Batch*, 16>>();
+        for (Batch& batch : pool) {
+            batch.rows.reset(new uint8_t[rowSize * batchRows]());
+            batch.count = 0;
+            freeBatches->tryPush(&batch);
+        }
+        columns.reset(new uint8_t[columnarRowSize * batchRows]());
+        current = nullptr;
+        samples = 0;
+        dropped = 0;
+        batchesWritten = 0;
+
+        running.store(true, std::memory_order_release);
+        ioThread = std::thread([this] { ioLoop(); });
+        return true;
+    }
+
+    bool isOpen() const { return file != nullptr; }
+
+    // Engine thread: true once per period; the caller then samples its
+    // books with SampleTrigger::TIMER at `nowNs`
+    bool timerDue(uint64_t nowNs) {
+        if (intervalNs == 0 || nowNs < nextTimerNs) {
+            return false;
+        }
+        // Skip whole missed periods rather than bursting to catch up
+        nextTimerNs = nextTimerNs + intervalNs > nowNs ? nextTimerNs + intervalNs : nowNs + intervalNs;
+        return true;
+    }
+
+    // Engine thread: copy the top levels of `book` into the current batch.
+    // `Book` provides copyDepth(side, prices, quantities, maxLevels).
+    template <typename Book>
+    bool sample(const Book& book, uint32_t instrumentId, uint64_t timestamp, SampleTrigger trigger) {
+        if (!current && !freeBatches->tryPop(current)) {
+            current = nullptr;
+            ++dropped;
+            return false;
+        }
+        uint8_t* row = current->rows.get() + size_t(current->count) * rowSize;
+        auto* header = reinterpret_cast<RowHeader*>(row);
+        auto* levels = reinterpret_cast<uint32_t*>(row + sizeof(RowHeader));
+        header->timestamp = timestamp;
+        header->instrumentId = instrumentId;
+        header->trigger = static_cast<uint8_t>(trigger);
+        header->bidLevels = static_cast<uint8_t>(book.copyDepth(OrderSide::BUY, levels, levels + depth, depth));
+        header->askLevels =
+            static_cast<uint8_t>(book.copyDepth(OrderSide::SELL, levels + 2 * depth, levels + 3 * depth, depth));
+        ++samples;
+        if (++current->count == batchRows) {
+            fullBatches->tryPush(current);
+            current = nullptr;
+        }
+        return true;
+    }
+
+    // Write the partial batch, drain the I/O thread and close the file
+    void close() {
+        if (!file) {
+            return;
+        }
+        if (current && current->count > 0) {
+            fullBatches->tryPush(current);
+        }
+        current = nullptr;
+        running.store(false, std::memory_order_release);
+        ioThread.join();
+        std::fclose(file);
+        file = nullptr;
+    }
+
+    uint32_t getDepth() const { return depth; }
+    uint64_t getSampleCount() const { return samples; }
+    uint64_t getDroppedCount() const { return dropped; }
+
+    // Valid after close()
+    uint64_t getBatchesWritten() const { return batchesWritten; }
+
+private:
+    void ioLoop() {
+        for (;;) {
+            bool stopping = !running.load(std::memory_order_acquire);
+            Batch* batch = nullptr;
+            if (fullBatches->tryPop(batch)) {
+                writeBatch(*batch);
+                batch->count = 0;
+                freeBatches->tryPush(batch);
+                continue;
+            }
+            if (stopping) {
+                std::fflush(file);
+                return;
+            }
+            std::this_thread::sleep_for(std::chrono::microseconds(200));
+        }
+    }
+
+    // Rows to columns: the timestamp column, then one u32 column per row
+    // header field and per level word
+    void writeBatch(const Batch& batch) {
+        const uint32_t rows = batch.count;
+        const uint32_t levelWords = 4 * depth;
+        const uint8_t* in = batch.rows.get();
+        auto* timestamps = reinterpret_cast<uint64_t*>(columns.get());
+        auto* words = reinterpret_cast<uint32_t*>(timestamps + rows);
+        for (uint32_t r = 0; r < rows; ++r) {
+            const auto* header = reinterpret_cast<const RowHeader*>(in + size_t(r) * rowSize);
+            const auto* levels = reinterpret_cast<const uint32_t*>(header + 1);
+            timestamps[r] = header->timestamp;
+            words[size_t(SampleFormat::INSTRUMENT) * rows + r] = header->instrumentId;
+            words[size_t(SampleFormat::TRIGGER) * rows + r] = header->trigger;
+            words[size_t(SampleFormat::BID_LEVELS) * rows + r] = header->bidLevels;
+            words[size_t(SampleFormat::ASK_LEVELS) * rows + r] = header->askLevels;
+            for (uint32_t w = 0; w < levelWords; ++w) {
+                words[size_t(SampleFormat::FIRST_LEVEL + w) * rows + r] = levels[w];
+            }
+        }
+
+        SampleBatchHeader frame{rows, 0, timestamps[0], timestamps[rows - 1]};
+        std::fwrite(&frame, sizeof(frame), 1, file);
+        std::fwrite(columns.get(), 1, size_t(rows) * columnarRowSize, file);
+        ++batchesWritten;
+    }
+};
+
+// Reads a sample file one batch at a time
+class SampleFileReader {
+private:
+    FILE* file = nullptr;
+    SampleFileHeader header{};
+    SampleBatchHeader batch{};
+    std::vector<uint64_t> timestamps;
+    std::vector<uint32_t> words;
+
+public:
+    SampleFileReader() = default;
+    SampleFileReader(const SampleFileReader&) = delete;
+    SampleFileReader& operator=(const SampleFileReader&) = delete;
+    ~SampleFileReader() { close(); }
+
+    bool open(const std::string& path) {
+        close();
+        file = std::fopen(path.c_str(), "rb");
+        if (!file) {
+            return false;
+        }
+        if (std::fread(&header, sizeof(header), 1, file) != 1 ||
+            std::memcmp(header.magic, SampleFormat::MAGIC, sizeof(header.magic)) != 0 ||
+            header.version != SampleFormat::VERSION || header.depth == 0 || header.depth > SampleFormat::MAX_DEPTH ||
+            header.columns != SampleFormat::columnCount(header.depth)) {
+            close();
+            return false;
+        }
+        return true;
+    }
+
+    void close() {
+        if (file) {
+            std::fclose(file);
+            file = nullptr;
+        }
+        batch = SampleBatchHeader{};
+    }
+
+    uint32_t getDepth() const { return header.depth; }
+
+    // Load the next batch; false at end of file
+    bool next() {
+        if (!file || std::fread(&batch, sizeof(batch), 1, file) != 1 || batch.rows == 0 ||
+            batch.rows > header.batchRows) {
+            batch = SampleBatchHeader{};
+            return false;
+        }
+        timestamps.resize(batch.rows);
+        words.resize(size_t(header.columns) * batch.rows);
+        if (std::fread(timestamps.data(), sizeof(uint64_t), batch.rows, file) != batch.rows ||
+            std::fread(words.data(), sizeof(uint32_t), words.size(), file) != words.size()) {
+            batch = SampleBatchHeader{};
+            return false;
+        }
+        return true;
+    }
+
+    // Current batch
+    uint32_t rows() const { return batch.rows; }
+    const uint64_t* timestampColumn() const { return timestamps.data(); }
+    const uint32_t* column(uint32_t index) const { return words.data() + size_t(index) * batch.rows; }
+};
+
+} // namespace HFT
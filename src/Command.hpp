@@ -0,0 +1,92 @@
+#pragma once
+
+#include "OrderBook.hpp"
+#include "SpscQueue.hpp"
+#include "Trace.hpp"
+#include <cstdint>
+
+namespace HFT {
+
+enum class CommandType : uint8_t {
+    NEW_ORDER = 0,
+    CANCEL_ORDER = 1,
+    MODIFY_ORDER = 2
+};
+
+// Order entry command as handed from a gateway to a matching shard
+struct Command {
+    uint64_t sequence;       // Stamped by the sequencer; 0 until then
+    uint64_t timestamp;      // Nanoseconds
+    uint64_t orderId;        // Target for cancel / modify
+    uint64_t sessionId;      // Originating gateway session
+    uint64_t clientTag;      // Echoed back to the client
+    uint32_t price;
+    uint32_t quantity;
+    CommandType type;
+    OrderSide side;
+    OrderType orderType;
+    TimeInForce timeInForce;
+    uint32_t traceSlot;      // MessageTracer slot; 0 = untraced
+};
+
+enum class CommandStatus : uint8_t {
+    ACCEPTED = 0,
+    REJECTED = 1,
+    BUSY = 2,                // Not queued: downstream ring was full
+    SHED = 3                 // Dropped unexecuted: shard overloaded
+};
+
+// Outcome of a command, routed back to the originating session
+struct CommandResponse {
+    uint64_t sessionId;
+    uint64_t clientTag;
+    uint64_t orderId;
+    CommandStatus status;
+    uint32_t traceSlot;      // Carried over from the command
+};
+
+using CommandQueue = SpscQueue<Command, 65536>;
+using ResponseQueue = SpscQueue<CommandResponse, 65536>;
+
+// Apply one command to a book
+inline CommandResponse applyCommand(OrderBook& book, const Command& cmd) {
+    CommandResponse response{cmd.sessionId, cmd.clientTag, cmd.orderId, CommandStatus::REJECTED, cmd.traceSlot};
+
+    switch (cmd.type) {
+    case CommandType::NEW_ORDER: {
+        uint64_t orderId = (cmd.orderType == OrderType::LIMIT && cmd.timeInForce == TimeInForce::GTC)
+            ? book.addOrder(cmd.price, cmd.quantity, cmd.side, cmd.timestamp)
+            : book.addOrder(cmd.price, cmd.quantity, cmd.side, cmd.timestamp, cmd.orderType, cmd.timeInForce);
+        response.orderId = orderId;
+        if (orderId != 0) {
+            response.status = CommandStatus::ACCEPTED;
+        }
+        break;
+    }
+    case CommandType::CANCEL_ORDER:
+        if (book.cancelOrder(cmd.orderId)) {
+            response.status = CommandStatus::ACCEPTED;
+        }
+        break;
+    case CommandType::MODIFY_ORDER:
+        if (book.modifyOrder(cmd.orderId, cmd.quantity)) {
+            response.status = CommandStatus::ACCEPTED;
+        }
+        break;
+    }
+
+    return response;
+}
+
+// Same, stamping match start / end when the command is traced
+inline CommandResponse applyCommand(OrderBook& book, const Command& cmd, MessageTracer* tracer) {
+    if (tracer && cmd.traceSlot) {
+        tracer->stamp(cmd.traceSlot, TraceStage::MATCH_START);
+        CommandResponse response = applyCommand(book, cmd);
+        tracer->stamp(cmd.traceSlot, TraceStage::MATCH_END);
+        return response;
+    }
+    return applyCommand(book, cmd);
+}
+
+} // namespace HFT
@@ -0,0 +1,198 @@
+#pragma once
+
+#include "OrderBook.hpp"
+#include "MarketByPriceBook.hpp"
+#include <array>
+#include <cstdint>
+
+namespace HFT {
+
+enum class FeedMessageType : uint8_t {
+    ADD_ORDER = 0,      // L3: new order (orderId is the exchange's ID)
+    CANCEL_ORDER = 1,   // L3: remove order
+    MODIFY_ORDER = 2,   // L3: change order quantity
+    LEVEL_UPDATE = 3,   // L2: set price level quantity / count
+    LEVEL_DELETE = 4    // L2: remove price level
+};
+
+// Normalized market data message as received on either feed line
+struct FeedMessage {
+    uint64_t sequence;
+    uint64_t timestamp;
+    uint64_t orderId;
+    uint32_t price;
+    uint32_t quantity;
+    uint32_t orderCount;
+    FeedMessageType type;
+    OrderSide side;
+};
+
+// Applies feed messages to a full L3 OrderBook. Orders rest under the
+// feed's own IDs (see OrderBook::addOrderWithId), so cancels and modifies
+// stay correct after skipped gaps; the book must not issue IDs itself.
+struct OrderBookFeedSink {
+    OrderBook& book;
+
+    void operator()(const FeedMessage& msg) {
+        switch (msg.type) {
+        case FeedMessageType::ADD_ORDER:
+            book.addOrderWithId(msg.orderId, msg.price, msg.quantity, msg.side, msg.timestamp);
+            break;
+        case FeedMessageType::CANCEL_ORDER:
+            book.cancelOrder(msg.orderId);
+            break;
+        case FeedMessageType::MODIFY_ORDER:
+            book.modifyOrder(msg.orderId, msg.quantity);
+            break;
+        default:
+            break;
+        }
+    }
+};
+
+// Applies feed messages to a levels-only MarketByPriceBook
+struct MarketByPriceFeedSink {
+    MarketByPriceBook& book;
+
+    void operator()(const FeedMessage& msg) {
+        if (msg.type == FeedMessageType::LEVEL_UPDATE) {
+            book.applyLevelUpdate(msg.side, msg.price, msg.quantity, msg.orderCount);
+        } else if (msg.type == FeedMessageType::LEVEL_DELETE) {
+            book.applyLevelDelete(msg.side, msg.price);
+        }
+    }
+};
+
+// A/B line arbitration. The first copy of each sequence number is applied
+// exactly once, in order; later copies are dropped. Messages that arrive
+// ahead of a gap are parked in a fixed window (a ring of slots plus an
+// occupancy bitmap) until the gap fills from the other line. No allocation
+// after construction; WindowSize must be a power of two.
+template <typename Sink, size_t WindowSize = 1024>
+class FeedArbitrator {
+    static_assert((WindowSize & (WindowSize - 1)) == 0, "WindowSize must be a power of two");
+    static_assert(WindowSize >= 64, "WindowSize must cover at least one bitmap word");
+
+public:
+    struct Stats {
+        uint64_t applied = 0;
+        uint64_t duplicates = 0;
+        uint64_t outOfOrder = 0;       // Parked until a gap filled
+        uint64_t gapsDetected = 0;
+        uint64_t messagesLost = 0;     // Missing on both lines, skipped
+        uint64_t firstArrivals[2] = {0, 0};
+    };
+
+private:
+    static constexpr uint64_t MASK = WindowSize - 1;
+
+    Sink sink;
+    uint64_t expectedSequence;
+    size_t bufferedCount = 0;
+    Stats stats;
+
+    std::array<uint64_t, WindowSize / 64> occupied{};
+    std::array<FeedMessage, WindowSize> window;
+
+public:
+    explicit FeedArbitrator(Sink s, uint64_t firstSequence = 1)
+        : sink(s), expectedSequence(firstSequence) {}
+
+    // Feed one message from line 0 (A) or line 1 (B)
+    void onMessage(uint32_t line, const FeedMessage& msg) {
+        const uint64_t seq = msg.sequence;
+
+        if (seq < expectedSequence) {
+            ++stats.duplicates;
+            return;
+        }
+
+        if (seq == expectedSequence) {
+            ++stats.firstArrivals[line & 1];
+            apply(msg);
+            drainBuffered();
+            return;
+        }
+
+        // Ahead of a gap. If it would not fit in the window, give up on the
+        // oldest missing messages until it does.
+        while (seq - expectedSequence >= WindowSize) {
+            if (bufferedCount == 0) {
+                ++stats.gapsDetected;
+                stats.messagesLost += seq - expectedSequence;
+                expectedSequence = seq;
+                break;
+            }
+            skipGap();
+        }
+        if (seq == expectedSequence) {
+            ++stats.firstArrivals[line & 1];
+            apply(msg);
+            drainBuffered();
+            return;
+        }
+
+        if (isBuffered(seq)) {
+            ++stats.duplicates;
+            return;
+        }
+        if (bufferedCount == 0) {
+            ++stats.gapsDetected;
+        }
+        ++stats.firstArrivals[line & 1];
+        ++stats.outOfOrder;
+        window[seq & MASK] = msg;
+        setBuffered(seq);
+        ++bufferedCount;
+    }
+
+    // Declare the current gap unrecoverable (e.g. after a timeout): skip
+    // the missing run and apply everything parked up to the next hole.
+    void skipGap() {
+        if (bufferedCount == 0) {
+            return;
+        }
+        while (!isBuffered(expectedSequence)) {
+            ++expectedSequence;
+            ++stats.messagesLost;
+        }
+        drainBuffered();
+    }
+
+    bool hasGap() const { return bufferedCount != 0; }
+    uint64_t getExpectedSequence() const { return expectedSequence; }
+    size_t getBufferedCount() const { return bufferedCount; }
+    const Stats& getStats() const { return stats; }
+
+private:
+    void apply(const FeedMessage& msg) {
+        sink(msg);
+        ++expectedSequence;
+        ++stats.applied;
+    }
+
+    void drainBuffered() {
+        while (bufferedCount != 0 && isBuffered(expectedSequence)) {
+            clearBuffered(expectedSequence);
+            --bufferedCount;
+            apply(window[expectedSequence & MASK]);
+        }
+    }
+
+    bool isBuffered(uint64_t seq) const {
+        uint64_t slot = seq & MASK;
+        return (occupied[slot >> 6] >> (slot & 63)) & 1;
+    }
+
+    void setBuffered(uint64_t seq) {
+        uint64_t slot = seq & MASK;
+        occupied[slot >> 6] |= uint64_t(1) << (slot & 63);
+    }
+
+    void clearBuffered(uint64_t seq) {
+        uint64_t slot = seq & MASK;
+        occupied[slot >> 6] &= ~(uint64_t(1) << (slot & 63));
+    }
+};
+
+} // namespace HFT
@@ -0,0 +1,527 @@
+#pragma once
+
+// Order entry gateway: an edge-triggered epoll reactor with one C++20
+// coroutine per TCP session. Linux only; requires C++20. With a tracer
+// attached it stamps receive, decode, encode and send for sampled messages.
+
+#include "Command.hpp"
+#include <atomic>
+#include <coroutine>
+#include <cstring>
+#include <exception>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include <arpa/inet.h>
+#include <cerrno>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace HFT {
+
+// Client -> gateway, fixed 32 bytes
+struct WireRequest {
+    uint64_t clientTag;
+    uint64_t orderId;        // Target for cancel / modify
+    uint32_t price;
+    uint32_t quantity;
+    CommandType type;
+    OrderSide side;
+    OrderType orderType;
+    TimeInForce timeInForce;
+    uint32_t reserved;
+};
+
+// Gateway -> client, fixed 24 bytes
+struct WireResponse {
+    uint64_t clientTag;
+    uint64_t orderId;
+    CommandStatus status;
+    uint8_t reserved[7];
+};
+
+static_assert(sizeof(WireRequest) == 32, "WireRequest layout");
+static_assert(sizeof(WireResponse) == 24, "WireResponse layout");
+
+// Coroutine return type for a session. Starts eagerly and stays suspended
+// at the end so the reactor can observe completion and destroy the frame.
+struct SessionTask {
+    struct promise_type {
+        SessionTask get_return_object() {
+            return SessionTask{std::coroutine_handle<promise_type>::from_promise(*this)};
+        }
+        std::suspend_never initial_suspend() noexcept { return {}; }
+        std::suspend_always final_suspend() noexcept { return {}; }
+        void return_void() {}
+        void unhandled_exception() { std::terminate(); }
+    };
+
+    std::coroutine_handle<promise_type> handle;
+};
+
+class GatewayReactor {
+public:
+    struct Stats {
+        uint64_t sessionsAccepted = 0;
+        uint64_t sessionsClosed = 0;
+        uint64_t requests = 0;
+        uint64_t busyRejects = 0;
+        uint64_t invalidRejects = 0;     // Malformed requests, never queued
+        uint64_t acceptsShed = 0;        // Accepted and closed at the fd limit
+        uint64_t responses = 0;
+        uint64_t wakeups = 0;
+        uint64_t readCalls = 0;
+        uint64_t writeCalls = 0;
+    };
+
+private:
+    static constexpr size_t BUFFER_SIZE = 64 * 1024;
+    static constexpr ssize_t WOULD_BLOCK = -1;
+    static constexpr ssize_t READ_ERROR = -2;
+    static constexpr uint64_t LISTEN_TAG = ~uint64_t(0);
+    static constexpr uint64_t WAKE_TAG = ~uint64_t(0) - 1;
+    static constexpr int MAX_EVENTS = 256;
+
+    struct Session {
+        int fd = -1;
+        uint64_t id = 0;             // slot | generation << 32
+        uint32_t generation = 0;
+        bool open = false;
+        bool closing = false;        // Close at the next safe point
+        bool flushQueued = false;
+        std::coroutine_handle<> readWaiter;
+        SessionTask task;
+
+        size_t inBegin = 0;
+        size_t inEnd = 0;
+        size_t outLength = 0;
+        std::unique_ptr<char[]> inBuffer{new char[BUFFER_SIZE]};
+        std::unique_ptr<char[]> outBuffer{new char[BUFFER_SIZE]};
+
+        uint64_t receiveTsc = 0;                          // Last recv, when tracing
+        std::vector<std::pair<size_t, uint32_t>> tracedOut; // (end offset in outBuffer, trace slot)
+    };
+
+    // Suspends the session until its socket is readable. Ready immediately
+    // if data (or EOF) is already there, so a busy session never suspends.
+    struct ReadAwaiter {
+        GatewayReactor& reactor;
+        Session& session;
+        ssize_t result = WOULD_BLOCK;
+
+        bool await_ready() {
+            result = reactor.readSome(session);
+            return result != WOULD_BLOCK;
+        }
+        void await_suspend(std::coroutine_handle<> handle) { session.readWaiter = handle; }
+        ssize_t await_resume() {
+            if (result == WOULD_BLOCK) {
+                result = reactor.readSome(session);
+            }
+            return result;
+        }
+    };
+
+    CommandQueue& toShard;
+    ResponseQueue& fromShard;
+    int epollFd = -1;
+    int listenFd = -1;
+    int wakeFd = -1;
+    int reserveFd = -1;              // Given up to accept-and-close at the fd limit
+    bool acceptPending = false;      // Accept stopped early; retry next wakeup
+
+    std::vector<std::unique_ptr<Session>> sessions;
+    std::vector<uint32_t> freeSlots;
+    std::vector<Session*> pendingFlush;
+    MessageTracer* tracer = nullptr;
+    Stats stats;
+
+public:
+    GatewayReactor(CommandQueue& commands, ResponseQueue& responses)
+        : toShard(commands), fromShard(responses) {}
+
+    ~GatewayReactor() {
+        for (auto& session : sessions) {
+            if (session->open) {
+                closeSession(*session);
+            }
+        }
+        if (listenFd >= 0) ::close(listenFd);
+        if (reserveFd >= 0) ::close(reserveFd);
+        if (wakeFd >= 0) ::close(wakeFd);
+        if (epollFd >= 0) ::close(epollFd);
+    }
+
+    // Bind and listen on 127.0.0.1:port (0 = ephemeral); returns the port or 0
+    uint16_t listen(uint16_t port, int backlog = 4096) {
+        epollFd = ::epoll_create1(0);
+        wakeFd = ::eventfd(0, EFD_NONBLOCK);
+        listenFd = ::socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK, 0);
+        reserveFd = ::open("/dev/null", O_RDONLY | O_CLOEXEC);
+        if (epollFd < 0 || wakeFd < 0 || listenFd < 0 || reserveFd < 0) {
+            return 0;
+        }
+
+        int one = 1;
+        ::setsockopt(listenFd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        addr.sin_port = htons(port);
+        if (::bind(listenFd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0 ||
+            ::listen(listenFd, backlog) < 0) {
+            return 0;
+        }
+        socklen_t len = sizeof(addr);
+        ::getsockname(listenFd, reinterpret_cast<sockaddr*>(&addr), &len);
+
+        addToEpoll(listenFd, EPOLLIN | EPOLLET, LISTEN_TAG);
+        addToEpoll(wakeFd, EPOLLIN | EPOLLET, WAKE_TAG);
+        return ntohs(addr.sin_port);
+    }
+
+    // Eventfd the shard signals after pushing responses
+    int getWakeFd() const { return wakeFd; }
+
+    // Reactor loop; returns when `running` is cleared
+    void run(const std::atomic<bool>& running, int timeoutMs = 1) {
+        epoll_event events[MAX_EVENTS];
+
+        while (running.load(std::memory_order_relaxed)) {
+            int n = ::epoll_wait(epollFd, events, MAX_EVENTS, timeoutMs);
+            ++stats.wakeups;
+
+            for (int i = 0; i < n; ++i) {
+                uint64_t tag = events[i].data.u64;
+                if (tag == LISTEN_TAG) {
+                    acceptAll();
+                } else if (tag == WAKE_TAG) {
+                    uint64_t count;
+                    while (::read(wakeFd, &count, sizeof(count)) > 0) {}
+                } else {
+                    onSessionEvent(static_cast<uint32_t>(tag), events[i].events);
+                }
+            }
+
+            // The listen edge is consumed even when accept stops early, so
+            // pick up what is still queued
+            if (acceptPending) {
+                acceptAll();
+            }
+
+            // Responses are drained every wakeup, not only on WAKE_TAG, so a
+            // coalesced eventfd edge can never strand them
+            drainResponses();
+            flushAll();
+        }
+    }
+
+    const Stats& getStats() const { return stats; }
+
+    // Sample messages into `t`; must be set before run()
+    void setTracer(MessageTracer* t) { tracer = t; }
+
+private:
+    void addToEpoll(int fd, uint32_t events, uint64_t tag) {
+        epoll_event ev{};
+        ev.events = events;
+        ev.data.u64 = tag;
+        ::epoll_ctl(epollFd, EPOLL_CTL_ADD, fd, &ev);
+    }
+
+    // Edge-triggered: accept until the queue is empty, or note that it is
+    // not so the next wakeup retries
+    void acceptAll() {
+        acceptPending = false;
+        for (;;) {
+            int fd = ::accept4(listenFd, nullptr, nullptr, SOCK_NONBLOCK);
+            if (fd < 0) {
+                if (errno == EINTR || errno == ECONNABORTED) {
+                    continue;
+                }
+                if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                    return;
+                }
+                if ((errno == EMFILE || errno == ENFILE) && reserveFd >= 0) {
+                    // Out of descriptors: free the reserve to accept and
+                    // close one connection, so the client sees a reset
+                    // rather than hanging in the backlog
+                    ::close(reserveFd);
+                    int shed = ::accept4(listenFd, nullptr, nullptr, SOCK_NONBLOCK);
+                    if (shed >= 0) {
+                        ::close(shed);
+                        ++stats.acceptsShed;
+                    }
+                    reserveFd = ::open("/dev/null", O_RDONLY | O_CLOEXEC);
+                    if (shed >= 0) {
+                        continue;
+                    }
+                }
+                acceptPending = true;   // ENOBUFS / ENOMEM etc.: retry later
+                return;
+            }
+            int one = 1;
+            ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+
+            uint32_t slot;
+            if (!freeSlots.empty()) {
+                slot = freeSlots.back();
+                freeSlots.pop_back();
+            } else {
+                slot = static_cast<uint32_t>(sessions.size());
+                sessions.push_back(std::make_unique<Session>());
+            }
+
+            Session& session = *sessions[slot];
+            session.fd = fd;
+            session.open = true;
+            session.closing = false;
+            session.id = slot | (uint64_t(session.generation) << 32);
+            session.inBegin = session.inEnd = session.outLength = 0;
+            ++stats.sessionsAccepted;
+
+            addToEpoll(fd, EPOLLIN | EPOLLOUT | EPOLLRDHUP | EPOLLET, slot);
+            session.task = runSession(session);
+            reapIfDone(session);
+        }
+    }
+
+    void onSessionEvent(uint32_t slot, uint32_t events) {
+        Session& session = *sessions[slot];
+        if (!session.open) {
+            return;
+        }
+        if ((events & EPOLLOUT) && session.outLength > 0) {
+            queueFlush(session);
+        }
+        if ((events & (EPOLLIN | EPOLLRDHUP | EPOLLHUP | EPOLLERR)) && session.readWaiter) {
+            auto waiter = session.readWaiter;
+            session.readWaiter = nullptr;
+            waiter.resume();
+            reapIfDone(session);
+        }
+    }
+
+    // One coroutine per connection: parse everything buffered, then await
+    // more bytes. Each command goes straight into the shard's ring.
+    SessionTask runSession(Session& session) {
+        for (;;) {
+            parseRequests(session);
+
+            ssize_t n = co_await ReadAwaiter{*this, session};
+            if (n == 0 || n == READ_ERROR) {
+                break;
+            }
+        }
+    }
+
+    ssize_t readSome(Session& session) {
+        // Compact so the buffer always has room for a full read
+        if (session.inBegin > 0) {
+            size_t remaining = session.inEnd - session.inBegin;
+            std::memmove(session.inBuffer.get(), session.inBuffer.get() + session.inBegin, remaining);
+            session.inBegin = 0;
+            session.inEnd = remaining;
+        }
+
+        ++stats.readCalls;
+        ssize_t n = ::recv(session.fd, session.inBuffer.get() + session.inEnd, BUFFER_SIZE - session.inEnd, 0);
+        if (n > 0) {
+            session.inEnd += static_cast<size_t>(n);
+            if (tracer) {
+                session.receiveTsc = readTsc();
+            }
+            return n;
+        }
+        if (n == 0) {
+            return 0;
+        }
+        return (errno == EAGAIN || errno == EWOULDBLOCK) ? WOULD_BLOCK : READ_ERROR;
+    }
+
+    static bool validRequest(const WireRequest& request) {
+        return request.type <= CommandType::MODIFY_ORDER && request.side <= OrderSide::SELL &&
+               request.orderType <= OrderType::POST_ONLY && request.timeInForce <= TimeInForce::FOK;
+    }
+
+    void parseRequests(Session& session) {
+        while (session.inEnd - session.inBegin >= sizeof(WireRequest)) {
+            WireRequest request;
+            std::memcpy(&request, session.inBuffer.get() + session.inBegin, sizeof(request));
+            session.inBegin += sizeof(request);
+            ++stats.requests;
+            uint32_t traceSlot = tracer ? tracer->sample(session.receiveTsc) : 0;
+            if (traceSlot) {
+                tracer->stamp(traceSlot, TraceStage::DECODE);
+            }
+
+            // Enum fields index the matching kernels: reject out-of-range
+            // values here, before they take a ring slot
+            if (!validRequest(request)) {
+                ++stats.invalidRejects;
+                appendResponse(session,
+                               {session.id, request.clientTag, request.orderId, CommandStatus::REJECTED, traceSlot});
+                continue;
+            }
+
+            Command* cmd = toShard.claim();
+            if (!cmd) {
+                ++stats.busyRejects;
+                appendResponse(session, {session.id, request.clientTag, request.orderId, CommandStatus::BUSY, traceSlot});
+                continue;
+            }
+            cmd->sequence = 0;
+            cmd->timestamp = 0;
+            cmd->orderId = request.orderId;
+            cmd->sessionId = session.id;
+            cmd->clientTag = request.clientTag;
+            cmd->price = request.price;
+            cmd->quantity = request.quantity;
+            cmd->type = request.type;
+            cmd->side = request.side;
+            cmd->orderType = request.orderType;
+            cmd->timeInForce = request.timeInForce;
+            cmd->traceSlot = traceSlot;
+            toShard.publish();
+        }
+    }
+
+    void drainResponses() {
+        while (CommandResponse* response = fromShard.front()) {
+            uint32_t slot = static_cast<uint32_t>(response->sessionId);
+            bool delivered = false;
+            if (slot < sessions.size()) {
+                Session& session = *sessions[slot];
+                if (session.open && session.id == response->sessionId) {
+                    appendResponse(session, *response);
+                    delivered = true;
+                }
+            }
+            if (!delivered && response->traceSlot) {
+                tracer->abandon(response->traceSlot);
+            }
+            fromShard.pop();
+        }
+    }
+
+    void appendResponse(Session& session, const CommandResponse& response) {
+        if (session.outLength + sizeof(WireResponse) > BUFFER_SIZE) {
+            flush(session);
+            if (session.outLength + sizeof(WireResponse) > BUFFER_SIZE) {
+                // Client is not reading; drop it rather than buffer without
+                // bound. May run inside the session's coroutine, so only mark.
+                session.closing = true;
+                queueFlush(session);
+                if (response.traceSlot) {
+                    tracer->abandon(response.traceSlot);
+                }
+                return;
+            }
+        }
+        WireResponse wire{};
+        wire.clientTag = response.clientTag;
+        wire.orderId = response.orderId;
+        wire.status = response.status;
+        std::memcpy(session.outBuffer.get() + session.outLength, &wire, sizeof(wire));
+        session.outLength += sizeof(wire);
+        if (response.traceSlot) {
+            tracer->stamp(response.traceSlot, TraceStage::ENCODE);
+            session.tracedOut.emplace_back(session.outLength, response.traceSlot);
+        }
+        ++stats.responses;
+        queueFlush(session);
+    }
+
+    void queueFlush(Session& session) {
+        if (!session.flushQueued) {
+            session.flushQueued = true;
+            pendingFlush.push_back(&session);
+        }
+    }
+
+    // One send per session per wakeup
+    void flushAll() {
+        for (Session* session : pendingFlush) {
+            session->flushQueued = false;
+            if (!session->open) {
+                continue;
+            }
+            if (session->closing) {
+                closeSession(*session);
+            } else {
+                flush(*session);
+            }
+        }
+        pendingFlush.clear();
+    }
+
+    void flush(Session& session) {
+        if (session.outLength == 0) {
+            return;
+        }
+        ++stats.writeCalls;
+        ssize_t n = ::send(session.fd, session.outBuffer.get(), session.outLength, MSG_NOSIGNAL);
+        if (n > 0) {
+            size_t sent = static_cast<size_t>(n);
+            std::memmove(session.outBuffer.get(), session.outBuffer.get() + sent, session.outLength - sent);
+            session.outLength -= sent;
+            if (!session.tracedOut.empty()) {
+                completeTraces(session, sent);
+            }
+        }
+        // On EAGAIN the remainder goes out on the next EPOLLOUT edge
+    }
+
+    // Traced responses wholly inside the first `sent` bytes are out
+    void completeTraces(Session& session, size_t sent) {
+        size_t done = 0;
+        for (auto& [end, slot] : session.tracedOut) {
+            if (end <= sent) {
+                tracer->stamp(slot, TraceStage::SEND);
+                tracer->complete(slot);
+                ++done;
+            } else {
+                end -= sent;
+            }
+        }
+        session.tracedOut.erase(session.tracedOut.begin(), session.tracedOut.begin() + done);
+    }
+
+    void reapIfDone(Session& session) {
+        if (session.task.handle && session.task.handle.done()) {
+            session.task.handle.destroy();
+            session.task.handle = nullptr;
+            if (session.open) {
+                closeSession(session);
+            }
+        }
+    }
+
+    void closeSession(Session& session) {
+        ::close(session.fd);
+        session.open = false;
+        session.fd = -1;
+        session.readWaiter = nullptr;
+        session.outLength = 0;
+        for (const auto& traced : session.tracedOut) {
+            tracer->abandon(traced.second);
+        }
+        session.tracedOut.clear();
+        ++session.generation;
+        ++stats.sessionsClosed;
+        if (session.task.handle) {
+            // Still suspended at a read: drop the frame
+            session.task.handle.destroy();
+            session.task.handle = nullptr;
+        }
+        freeSlots.push_back(static_cast<uint32_t>(session.id));
+    }
+};
+
+} // namespace HFT
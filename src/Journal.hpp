@@ -0,0 +1,265 @@
+#pragma once
+
+#include "BlockCompression.hpp"
+#include "Command.hpp"
+#include "SpscQueue.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <thread>
+
+namespace HFT {
+
+// Command journal layout: MAGIC followed by raw, fixed-size Command
+// records in sequence order, or a block-compressed file of the same
+// records (see BlockCompression.hpp) under COMPRESSED_MAGIC. Replaying it
+// through applyCommand() in a fresh book reproduces the original run
+// exactly.
+namespace JournalFormat {
+constexpr char MAGIC[8] = {'H', 'F', 'T', 'J', 'R', 'N', 'L', '1'};
+constexpr char COMPRESSED_MAGIC[8] = {'H', 'F', 'T', 'J', 'R', 'N', 'Z', '1'};
+} // namespace JournalFormat
+
+// Append-only journal writer. On the caller's (sequencer's) thread a record
+// is only copied into a buffer: in raw mode full buffers go to the writer's
+// own I/O thread for the fwrite, and in compressed mode records are handed
+// to a CompressedBlockWriter, whose I/O thread does the compression. The
+// caller waits only if the I/O thread has fallen a whole pool behind
+// (counted in getPoolStalls()); records are never dropped.
+class JournalWriter {
+private:
+    static constexpr size_t BUFFER_RECORDS = 16384;
+    static constexpr size_t POOL_BUFFERS = 4;
+
+    struct Buffer {
+        std::unique_ptr<Command[]> records;
+        size_t count = 0;
+    };
+    using BufferQueue = SpscQueue<Buffer*, 8>;
+
+    FILE* file = nullptr;
+    Buffer pool[POOL_BUFFERS];
+    std::unique_ptr<BufferQueue> fullBuffers;
+    std::unique_ptr<BufferQueue> freeBuffers;
+    Buffer* current = nullptr;
+    uint64_t recordCount = 0;
+    uint64_t poolStalls = 0;
+    std::unique_ptr<CompressedBlockWriter> compressor;
+
+    // I/O thread
+    std::thread ioThread;
+    std::atomic<bool> running{false};
+
+public:
+    JournalWriter() = default;
+    JournalWriter(const JournalWriter&) = delete;
+    JournalWriter& operator=(const JournalWriter&) = delete;
+    ~JournalWriter() { close(); }
+
+    // False if already open
+    bool open(const std::string& path, bool compressed = false) {
+        if (isOpen()) {
+            return false;
+        }
+        recordCount = 0;
+        poolStalls = 0;
+        if (compressed) {
+            compressor = std::make_unique<CompressedBlockWriter>();
+            if (!compressor->open(path, JournalFormat::COMPRESSED_MAGIC, sizeof(Command))) {
+                compressor.reset();
+                return false;
+            }
+            return true;
+        }
+        file = std::fopen(path.c_str(), "wb");
+        if (!file) {
+            return false;
+        }
+        std::fwrite(JournalFormat::MAGIC, 1, sizeof(JournalFormat::MAGIC), file);
+
+        // Fresh queues: nothing handed back by a previous session survives
+        fullBuffers = std::make_unique<BufferQueue>();
+        freeBuffers = std::make_unique<BufferQueue>();
+        for (Buffer& buffer : pool) {
+            if (!buffer.records) {
+                buffer.records.reset(new Command[BUFFER_RECORDS]);
+            }
+            buffer.count = 0;
+            freeBuffers->tryPush(&buffer);
+        }
+        current = nullptr;
+        running.store(true, std::memory_order_release);
+        ioThread = std::thread([this] { ioLoop(); });
+        return true;
+    }
+
+    bool isOpen() const { return file != nullptr || (compressor && compressor->isOpen()); }
+
+    void append(const Command& cmd) {
+        if (compressor) {
+            compressor->append(&cmd, cmd.sequence);
+            return;
+        }
+        if (!current) {
+            while (!freeBuffers->tryPop(current)) {
+                ++poolStalls;
+                std::this_thread::yield();
+            }
+            current->count = 0;
+        }
+        current->records[current->count] = cmd;
+        ++recordCount;
+        if (++current->count == BUFFER_RECORDS) {
+            flush();
+        }
+    }
+
+    // Hand the partial buffer to the I/O thread
+    void flush() {
+        if (current && current->count > 0) {
+            fullBuffers->tryPush(current);
+            current = nullptr;
+        }
+    }
+
+    // Drain the I/O thread and close the file
+    void close() {
+        if (file) {
+            flush();
+            running.store(false, std::memory_order_release);
+            ioThread.join();
+            std::fclose(file);
+            file = nullptr;
+        }
+        if (compressor) {
+            compressor->close();
+            recordCount = compressor->getRecordCount();
+            poolStalls = compressor->getPoolStalls();
+            compressor.reset();   // A raw reopen must not route into it
+        }
+    }
+
+    uint64_t getRecordCount() const { return compressor ? compressor->getRecordCount() : recordCount; }
+    uint64_t getPoolStalls() const { return compressor ? compressor->getPoolStalls() : poolStalls; }
+
+private:
+    void ioLoop() {
+        for (;;) {
+            bool stopping = !running.load(std::memory_order_acquire);
+            Buffer* buffer = nullptr;
+            if (fullBuffers->tryPop(buffer)) {
+                std::fwrite(buffer->records.get(), sizeof(Command), buffer->count, file);
+                freeBuffers->tryPush(buffer);
+                continue;
+            }
+            if (stopping) {
+                std::fflush(file);
+                return;
+            }
+            std::this_thread::sleep_for(std::chrono::microseconds(50));
+        }
+    }
+};
+
+// Sequential journal reader for both raw and compressed journals
+class JournalReader {
+private:
+    FILE* file = nullptr;
+    std::unique_ptr<CompressedBlockReader> blocks;
+    size_t blockIndex = 0;
+    size_t blockPosition = 0;
+
+public:
+    JournalReader() = default;
+    JournalReader(const JournalReader&) = delete;
+    JournalReader& operator=(const JournalReader&) = delete;
+    ~JournalReader() { close(); }
+
+    bool open(const std::string& path) {
+        file = std::fopen(path.c_str(), "rb");
+        if (!file) {
+            return false;
+        }
+        char magic[sizeof(JournalFormat::MAGIC)];
+        if (std::fread(magic, 1, sizeof(magic), file) != sizeof(magic)) {
+            close();
+            return false;
+        }
+        if (std::memcmp(magic, JournalFormat::MAGIC, sizeof(magic)) == 0) {
+            return true;
+        }
+        close();
+        if (std::memcmp(magic, JournalFormat::COMPRESSED_MAGIC, sizeof(magic)) == 0) {
+            blocks = std::make_unique<CompressedBlockReader>();
+            blockIndex = 0;
+            blockPosition = 0;
+            if (blocks->open(path, JournalFormat::COMPRESSED_MAGIC) && blocks->getRecordSize() == sizeof(Command)) {
+                return true;
+            }
+            blocks.reset();
+        }
+        return false;
+    }
+
+    // Read up to `max` records; returns the number read (0 at end)
+    size_t read(Command* out, size_t max) {
+        if (blocks) {
+            return readCompressed(out, max);
+        }
+        return file ? std::fread(out, sizeof(Command), max, file) : 0;
+    }
+
+    void close() {
+        if (file) {
+            std::fclose(file);
+            file = nullptr;
+        }
+        blocks.reset();
+    }
+
+private:
+    size_t readCompressed(Command* out, size_t max) {
+        size_t total = 0;
+        while (total < max && blockIndex < blocks->getBlockCount()) {
+            const uint8_t* records = blocks->readBlock(blockIndex);
+            if (!records) {
+                break;
+            }
+            size_t available = blocks->getBlock(blockIndex).records - blockPosition;
+            size_t n = std::min(available, max - total);
+            std::memcpy(out + total, records + blockPosition * sizeof(Command), n * sizeof(Command));
+            total += n;
+            blockPosition += n;
+            if (blockPosition == blocks->getBlock(blockIndex).records) {
+                ++blockIndex;
+                blockPosition = 0;
+            }
+        }
+        return total;
+    }
+};
+
+// Replay a journal into any command sink; returns the number of commands
+template <typename Sink>
+uint64_t replayJournal(const std::string& path, Sink&& sink) {
+    JournalReader reader;
+    if (!reader.open(path)) {
+        return 0;
+    }
+    constexpr size_t BATCH = 4096;
+    std::unique_ptr<Command[]> batch(new Command[BATCH]);
+    uint64_t total = 0;
+    while (size_t n = reader.read(batch.get(), BATCH)) {
+        for (size_t i = 0; i < n; ++i) {
+            sink(batch[i]);
+        }
+        total += n;
+    }
+    return total;
+}
+
+} // namespace HFT
@@ -0,0 +1,302 @@
+#pragma once
+
+#include "SpscQueue.hpp"
+#include "Tsc.hpp"
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace HFT {
+
+// Binary log layout shared by the writer and tools/log_decoder.cpp:
+//   file    := MAGIC record*
+//   record  := TAG_FORMAT    u32 id, u32 line, u32 len, file, u32 len, format
+//            | TAG_ENTRY     u32 formatId, u64 tsc, u8 argc, arg*
+//            | TAG_CALIBRATE u64 tsc, u64 wallClockNs
+//   arg     := u8 LogArgType, (u32 len, bytes  if STR  |  u64 otherwise)
+// Integers are little-endian as written by the host.
+namespace BinaryLog {
+constexpr char MAGIC[8] = {'H', 'F', 'T', 'L', 'O', 'G', '1', '\0'};
+constexpr uint8_t TAG_FORMAT = 1;
+constexpr uint8_t TAG_ENTRY = 2;
+constexpr uint8_t TAG_CALIBRATE = 3;
+} // namespace BinaryLog
+
+enum class LogArgType : uint8_t {
+    NONE = 0,
+    I64 = 1,
+    U64 = 2,
+    F64 = 3,
+    STR = 4,     // Pointer to a string with static storage duration
+    CHAR = 5
+};
+
+constexpr size_t LOG_MAX_ARGS = 5;
+
+// Fixed-size record as queued by the engine thread: no formatting, just the
+// format ID, a cycle-counter timestamp and the raw argument bits. Sized to
+// exactly one cache line.
+struct alignas(64) LogRecord {
+    uint64_t tsc;
+    uint32_t formatId;
+    uint8_t argCount;
+    LogArgType argTypes[LOG_MAX_ARGS];
+    uint64_t args[LOG_MAX_ARGS];
+};
+
+static_assert(sizeof(LogRecord) == 64, "LogRecord should fill one cache line");
+
+namespace detail {
+
+template <typename T>
+inline void encodeLogArg(LogRecord& record, size_t index, T value) {
+    using U = std::decay_t<T>;
+    if constexpr (std::is_same_v<U, char>) {
+        record.argTypes[index] = LogArgType::CHAR;
+        record.args[index] = static_cast<uint8_t>(value);
+    } else if constexpr (std::is_same_v<U, bool>) {
+        record.argTypes[index] = LogArgType::U64;
+        record.args[index] = value ? 1 : 0;
+    } else if constexpr (std::is_enum_v<U>) {
+        record.argTypes[index] = LogArgType::U64;
+        record.args[index] = static_cast<uint64_t>(value);
+    } else if constexpr (std::is_integral_v<U> && std::is_signed_v<U>) {
+        record.argTypes[index] = LogArgType::I64;
+        record.args[index] = static_cast<uint64_t>(static_cast<int64_t>(value));
+    } else if constexpr (std::is_integral_v<U>) {
+        record.argTypes[index] = LogArgType::U64;
+        record.args[index] = static_cast<uint64_t>(value);
+    } else if constexpr (std::is_floating_point_v<U>) {
+        double d = static_cast<double>(value);
+        record.argTypes[index] = LogArgType::F64;
+        std::memcpy(&record.args[index], &d, sizeof(d));
+    } else {
+        static_assert(std::is_convertible_v<U, const char*>, "Unsupported log argument type");
+        record.argTypes[index] = LogArgType::STR;
+        record.args[index] = reinterpret_cast<uintptr_t>(static_cast<const char*>(value));
+    }
+}
+
+} // namespace detail
+
+// Asynchronous binary logger. Engine threads copy a LogRecord into their own
+// SPSC ring; a background thread drains all rings and writes the binary
+// format above. Rendering to text happens offline in the decoder. A full
+// ring drops the record (and counts it) rather than block the caller.
+class Logger {
+public:
+    static constexpr size_t RING_CAPACITY = 16384;
+
+private:
+    struct ThreadBuffer {
+        SpscQueue<LogRecord, RING_CAPACITY> ring;
+        std::atomic<uint64_t> dropped{0};
+    };
+
+    struct FormatInfo {
+        const char* file;
+        int line;
+        const char* format;
+    };
+
+    std::mutex registryMutex;
+    std::vector<FormatInfo> formats;
+    std::vector<std::unique_ptr<ThreadBuffer>> buffers;
+
+    std::thread writer;
+    std::atomic<bool> running{false};
+    FILE* file = nullptr;
+    size_t formatsWritten = 0;
+
+public:
+    static Logger& instance() {
+        static Logger logger;
+        return logger;
+    }
+
+    ~Logger() { stop(); }
+
+    // Open the output file and start the background writer
+    bool start(const std::string& path) {
+        if (running.load()) {
+            return false;
+        }
+        file = std::fopen(path.c_str(), "wb");
+        if (!file) {
+            return false;
+        }
+        std::setvbuf(file, nullptr, _IOFBF, 1 << 20);
+        std::fwrite(BinaryLog::MAGIC, 1, sizeof(BinaryLog::MAGIC), file);
+        formatsWritten = 0;
+        writeCalibration();
+
+        running.store(true, std::memory_order_release);
+        writer = std::thread([this] { writerLoop(); });
+        return true;
+    }
+
+    // Drain everything still queued, then close the file
+    void stop() {
+        if (!running.exchange(false)) {
+            return;
+        }
+        writer.join();
+        drainAll();
+        writeCalibration();
+        std::fclose(file);
+        file = nullptr;
+    }
+
+    // Assigns a stable ID to a format string; called once per log site
+    static uint32_t registerFormat(const char* sourceFile, int line, const char* format) {
+        Logger& logger = instance();
+        std::lock_guard<std::mutex> lock(logger.registryMutex);
+        logger.formats.push_back({sourceFile, line, format});
+        return static_cast<uint32_t>(logger.formats.size() - 1);
+    }
+
+    // Hot path: one ring slot, a TSC read and raw argument stores
+    template <typename... Args>
+    static void log(uint32_t formatId, const Args&... args) {
+        static_assert(sizeof...(Args) <= LOG_MAX_ARGS, "Too many log arguments");
+
+        ThreadBuffer* buffer = threadBuffer();
+        LogRecord* record = buffer->ring.claim();
+        if (!record) {
+            buffer->dropped.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+
+        record->tsc = readTsc();
+        record->formatId = formatId;
+        record->argCount = static_cast<uint8_t>(sizeof...(Args));
+        size_t index = 0;
+        (detail::encodeLogArg(*record, index++, args), ...);
+        (void)index;
+        buffer->ring.publish();
+    }
+
+    // Allocate the calling thread's ring up front, so the first log call on
+    // an engine thread does not allocate
+    static void preallocateThreadBuffer() { threadBuffer(); }
+
+    uint64_t getDroppedCount() {
+        std::lock_guard<std::mutex> lock(registryMutex);
+        uint64_t total = 0;
+        for (const auto& buffer : buffers) {
+            total += buffer->dropped.load(std::memory_order_relaxed);
+        }
+        return total;
+    }
+
+private:
+    Logger() = default;
+
+    static ThreadBuffer* threadBuffer() {
+        thread_local ThreadBuffer* buffer = nullptr;
+        if (!buffer) {
+            Logger& logger = instance();
+            auto owned = std::make_unique<ThreadBuffer>();
+            buffer = owned.get();
+            std::lock_guard<std::mutex> lock(logger.registryMutex);
+            logger.buffers.push_back(std::move(owned));
+        }
+        return buffer;
+    }
+
+    void writerLoop() {
+        while (running.load(std::memory_order_acquire)) {
+            if (drainAll() == 0) {
+                std::this_thread::sleep_for(std::chrono::microseconds(100));
+            }
+        }
+    }
+
+    size_t drainAll() {
+        std::vector<ThreadBuffer*> snapshot;
+        {
+            std::lock_guard<std::mutex> lock(registryMutex);
+            snapshot.reserve(buffers.size());
+            for (auto& buffer : buffers) {
+                snapshot.push_back(buffer.get());
+            }
+        }
+
+        size_t drained = 0;
+        for (ThreadBuffer* buffer : snapshot) {
+            while (LogRecord* record = buffer->ring.front()) {
+                writeEntry(*record);
+                buffer->ring.pop();
+                ++drained;
+            }
+        }
+        return drained;
+    }
+
+    void writeEntry(const LogRecord& record) {
+        if (record.formatId >= formatsWritten) {
+            writeNewFormats();
+        }
+
+        writeValue(BinaryLog::TAG_ENTRY);
+        writeValue(record.formatId);
+        writeValue(record.tsc);
+        writeValue(record.argCount);
+        for (uint8_t i = 0; i < record.argCount; ++i) {
+            writeValue(record.argTypes[i]);
+            if (record.argTypes[i] == LogArgType::STR) {
+                writeString(reinterpret_cast<const char*>(static_cast<uintptr_t>(record.args[i])));
+            } else {
+                writeValue(record.args[i]);
+            }
+        }
+    }
+
+    void writeNewFormats() {
+        std::lock_guard<std::mutex> lock(registryMutex);
+        for (; formatsWritten < formats.size(); ++formatsWritten) {
+            const FormatInfo& info = formats[formatsWritten];
+            writeValue(BinaryLog::TAG_FORMAT);
+            writeValue(static_cast<uint32_t>(formatsWritten));
+            writeValue(static_cast<uint32_t>(info.line));
+            writeString(info.file);
+            writeString(info.format);
+        }
+    }
+
+    void writeCalibration() {
+        writeValue(BinaryLog::TAG_CALIBRATE);
+        writeValue(readTsc());
+        writeValue(wallClockNs());
+    }
+
+    template <typename T>
+    void writeValue(const T& value) {
+        std::fwrite(&value, sizeof(T), 1, file);
+    }
+
+    void writeString(const char* str) {
+        uint32_t len = str ? static_cast<uint32_t>(std::strlen(str)) : 0;
+        writeValue(len);
+        std::fwrite(str, 1, len, file);
+    }
+};
+
+} // namespace HFT
+
+// Log with a compile-time format string using {} placeholders, e.g.
+//   HFT_LOG("order {} filled {} @ {}", orderId, qty, price);
+// String arguments must outlive the background writer (literals, statics).
+#define HFT_LOG(format, ...)                                                          \
+    do {                                                                              \
+        static const uint32_t hftLogFormatId_ =                                       \
+            ::HFT::Logger::registerFormat(__FILE__, __LINE__, format);                \
+        ::HFT::Logger::log(hftLogFormatId_, ##__VA_ARGS__);                           \
+    } while (0)
@@ -0,0 +1,250 @@
+#pragma once
+
+// Small LZ77 block codec using the LZ4 block format: each sequence is a
+// token (literal length << 4 | match length - 4), optional length bytes,
+// the literals, and a 2-byte little-endian match offset. The last sequence
+// is literals only. Greedy single-probe hash matching; decoding is
+// bounds-checked and copies matches 8 bytes at a time.
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace HFT {
+namespace Lz {
+
+constexpr size_t MIN_MATCH = 4;
+constexpr size_t LAST_LITERALS = 5;     // Last bytes are always literals
+constexpr size_t MF_LIMIT = 12;         // No match may start after end - 12
+constexpr size_t MAX_DISTANCE = 65535;
+constexpr uint32_t HASH_BITS = 14;
+constexpr size_t HASH_ENTRIES = size_t(1) << HASH_BITS;
+
+constexpr size_t compressBound(size_t size) {
+    return size + size / 255 + 16;
+}
+
+namespace detail {
+
+inline uint32_t read32(const uint8_t* p) {
+    uint32_t v;
+    std::memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+inline uint64_t read64(const uint8_t* p) {
+    uint64_t v;
+    std::memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+// Index of the lowest set bit; `x` must be non-zero
+inline unsigned lowestBit(uint64_t x) {
+#if defined(_MSC_VER)
+    unsigned long index;
+    _BitScanForward64(&index, x);
+    return static_cast<unsigned>(index);
+#else
+    return static_cast<unsigned>(__builtin_ctzll(x));
+#endif
+}
+
+inline uint32_t hash(uint32_t sequence) {
+    return (sequence * 2654435761u) >> (32 - HASH_BITS);
+}
+
+inline uint8_t* writeLength(uint8_t* op, size_t length) {
+    while (length >= 255) {
+        *op++ = 255;
+        length -= 255;
+    }
+    *op++ = static_cast<uint8_t>(length);
+    return op;
+}
+
+inline uint8_t* writeSequence(uint8_t* op, const uint8_t* literals, size_t literalLength) {
+    uint8_t* token = op++;
+    *token = static_cast<uint8_t>((literalLength >= 15 ? 15 : literalLength) << 4);
+    if (literalLength >= 15) {
+        op = writeLength(op, literalLength - 15);
+    }
+    if (literalLength > 0) {
+        std::memcpy(op, literals, literalLength);
+    }
+    return op + literalLength;
+}
+
+} // namespace detail
+
+// Returns the compressed size, or 0 if dstCapacity < compressBound(srcSize).
+// `table` is HASH_ENTRIES entries of caller-owned scratch, reused across
+// calls so compressing a block never allocates.
+inline size_t compress(const uint8_t* src, size_t srcSize, uint8_t* dst, size_t dstCapacity, uint32_t* table) {
+    if (dstCapacity < compressBound(srcSize)) {
+        return 0;
+    }
+
+    std::memset(table, 0, HASH_ENTRIES * sizeof(uint32_t));
+    const uint8_t* const end = src + srcSize;
+    const uint8_t* ip = src;
+    const uint8_t* anchor = src;
+    uint8_t* op = dst;
+
+    if (srcSize > MF_LIMIT) {
+        const uint8_t* const matchLimit = end - LAST_LITERALS;
+        const uint8_t* const ipLimit = end - MF_LIMIT;
+        ++ip;
+
+        while (ip < ipLimit) {
+            uint32_t sequence = detail::read32(ip);
+            uint32_t h = detail::hash(sequence);
+            const uint8_t* ref = src + table[h];
+            table[h] = static_cast<uint32_t>(ip - src);
+
+            if (ref >= ip || static_cast<size_t>(ip - ref) > MAX_DISTANCE || detail::read32(ref) != sequence) {
+                // Skip faster through incompressible stretches
+                ip += 1 + ((ip - anchor) >> 6);
+                continue;
+            }
+
+            while (ip > anchor && ref > src && ip[-1] == ref[-1]) {
+                --ip;
+                --ref;
+            }
+
+            const uint8_t* mp = ip + MIN_MATCH;
+            const uint8_t* rp = ref + MIN_MATCH;
+            while (mp + 8 <= matchLimit) {
+                uint64_t diff = detail::read64(mp) ^ detail::read64(rp);
+                if (diff != 0) {
+                    mp += detail::lowestBit(diff) >> 3;
+                    goto matched;
+                }
+                mp += 8;
+                rp += 8;
+            }
+            while (mp < matchLimit && *mp == *rp) {
+                ++mp;
+                ++rp;
+            }
+        matched:
+            {
+                size_t literalLength = static_cast<size_t>(ip - anchor);
+                size_t matchLength = static_cast<size_t>(mp - ip) - MIN_MATCH;
+                uint8_t* token = op;
+                op = detail::writeSequence(op, anchor, literalLength);
+                *token |= static_cast<uint8_t>(matchLength >= 15 ? 15 : matchLength);
+
+                size_t offset = static_cast<size_t>(ip - ref);
+                *op++ = static_cast<uint8_t>(offset);
+                *op++ = static_cast<uint8_t>(offset >> 8);
+                if (matchLength >= 15) {
+                    op = detail::writeLength(op, matchLength - 15);
+                }
+
+                ip = mp;
+                anchor = ip;
+                if (ip < ipLimit) {
+                    table[detail::hash(detail::read32(ip - 2))] = static_cast<uint32_t>(ip - 2 - src);
+                }
+            }
+        }
+    }
+
+    op = detail::writeSequence(op, anchor, static_cast<size_t>(end - anchor));
+    return static_cast<size_t>(op - dst);
+}
+
+// Returns the decompressed size, or 0 on malformed input / short output
+inline size_t decompress(const uint8_t* src, size_t srcSize, uint8_t* dst, size_t dstCapacity) {
+    const uint8_t* ip = src;
+    const uint8_t* const iend = src + srcSize;
+    uint8_t* op = dst;
+    uint8_t* const oend = dst + dstCapacity;
+
+    while (ip < iend) {
+        unsigned token = *ip++;
+
+        size_t literalLength = token >> 4;
+        if (literalLength == 15) {
+            uint8_t b;
+            do {
+                if (ip >= iend) return 0;
+                b = *ip++;
+                literalLength += b;
+            } while (b == 255);
+        }
+        if (literalLength > static_cast<size_t>(iend - ip) || literalLength > static_cast<size_t>(oend - op)) {
+            return 0;
+        }
+        if (literalLength <= 16 && iend - ip >= 16 && oend - op >= 16) {
+            std::memcpy(op, ip, 16); // Fixed-size copy; slack is overwritten later
+        } else {
+            std::memcpy(op, ip, literalLength);
+        }
+        op += literalLength;
+        ip += literalLength;
+
+        if (ip == iend) {
+            break; // Final literals-only sequence
+        }
+        if (iend - ip < 2) {
+            return 0;
+        }
+        size_t offset = static_cast<size_t>(ip[0]) | (static_cast<size_t>(ip[1]) << 8);
+        ip += 2;
+        if (offset == 0 || offset > static_cast<size_t>(op - dst)) {
+            return 0;
+        }
+
+        size_t matchLength = token & 15;
+        if (matchLength == 15) {
+            uint8_t b;
+            do {
+                if (ip >= iend) return 0;
+                b = *ip++;
+                matchLength += b;
+            } while (b == 255);
+        }
+        matchLength += MIN_MATCH;
+        if (matchLength > static_cast<size_t>(oend - op)) {
+            return 0;
+        }
+
+        uint8_t* const copyEnd = op + matchLength;
+        const uint8_t* match = op - offset;
+        if (offset < 8) {
+            // Short period (runs of one byte, repeating words): copy one
+            // period multiple >= 8 bytewise, then read from that distance
+            size_t step = offset * ((8 + offset - 1) / offset);
+            size_t head = matchLength < step ? matchLength : step;
+            for (size_t i = 0; i < head; ++i) {
+                op[i] = match[i];
+            }
+            op += head;
+            match = op - step;
+        }
+        if (oend - copyEnd >= 8) {
+            // Distance >= 8, so 8-byte steps never overlap; up to 7 bytes of
+            // slack past copyEnd are overwritten by later output
+            while (op < copyEnd) {
+                std::memcpy(op, match, 8);
+                op += 8;
+                match += 8;
+            }
+        } else {
+            while (op < copyEnd) {
+                *op++ = *match++;
+            }
+        }
+        op = copyEnd;
+    }
+    return static_cast<size_t>(op - dst);
+}
+
+} // namespace Lz
+} // namespace HFT
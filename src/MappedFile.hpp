@@ -0,0 +1,119 @@
+#pragma once
+
+// Growable memory-mapped file (POSIX)
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace HFT {
+
+class MappedFile {
+private:
+    int fd = -1;
+    char* base = nullptr;
+    size_t mappedSize = 0;
+    bool writable = false;
+
+public:
+    MappedFile() = default;
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    ~MappedFile() { close(); }
+
+    // Writable mappings create the file if needed; read-only mappings map
+    // the current file size
+    bool open(const std::string& path, bool forWrite) {
+        writable = forWrite;
+        fd = forWrite ? ::open(path.c_str(), O_RDWR | O_CREAT, 0644) : ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            return false;
+        }
+        struct stat st;
+        if (::fstat(fd, &st) < 0) {
+            close();
+            return false;
+        }
+        return st.st_size == 0 || map(static_cast<size_t>(st.st_size));
+    }
+
+    // Grow the file (and mapping) to at least `bytes`, in steps of `chunk`
+    bool reserve(size_t bytes, size_t chunk = 64 << 20) {
+        if (bytes <= mappedSize) {
+            return true;
+        }
+        size_t newSize = ((bytes + chunk - 1) / chunk) * chunk;
+        if (::ftruncate(fd, static_cast<off_t>(newSize)) < 0) {
+            return false;
+        }
+        return map(newSize);
+    }
+
+    // Re-map a read-only file that another process has grown
+    bool refresh() {
+        struct stat st;
+        if (::fstat(fd, &st) < 0) {
+            return false;
+        }
+        return static_cast<size_t>(st.st_size) <= mappedSize || map(static_cast<size_t>(st.st_size));
+    }
+
+    void sync() {
+        if (base) {
+            ::msync(base, mappedSize, MS_ASYNC);
+        }
+    }
+
+    void close() {
+        if (base) {
+            ::munmap(base, mappedSize);
+            base = nullptr;
+            mappedSize = 0;
+        }
+        if (fd >= 0) {
+            ::close(fd);
+            fd = -1;
+        }
+    }
+
+    // Shrink the file to exactly `bytes` (after the last append)
+    void truncate(size_t bytes) {
+        if (writable && fd >= 0) {
+            if (::ftruncate(fd, static_cast<off_t>(bytes)) == 0 && bytes < mappedSize) {
+                map(bytes);
+            }
+        }
+    }
+
+    char* data() { return base; }
+    const char* data() const { return base; }
+    size_t size() const { return mappedSize; }
+    bool isOpen() const { return fd >= 0; }
+
+private:
+    bool map(size_t bytes) {
+        if (base) {
+            ::munmap(base, mappedSize);
+            base = nullptr;
+            mappedSize = 0;
+        }
+        if (bytes == 0) {
+            return true;
+        }
+        int prot = writable ? (PROT_READ | PROT_WRITE) : PROT_READ;
+        void* p = ::mmap(nullptr, bytes, prot, MAP_SHARED, fd, 0);
+        if (p == MAP_FAILED) {
+            return false;
+        }
+        base = static_cast<char*>(p);
+        mappedSize = bytes;
+        return true;
+    }
+};
+
+} // namespace HFT
@@ -0,0 +1,140 @@
+#pragma once
+
+#include "Order.hpp"
+#include <vector>
+#include <algorithm>
+#include <iostream>
+
+namespace HFT {
+
+// Aggregated price level as published by an L2 (market-by-price) feed
+struct LevelSummary {
+    uint32_t price;
+    uint32_t quantity;
+    uint32_t orderCount;
+
+    LevelSummary(uint32_t p, uint32_t qty, uint32_t count) : price(p), quantity(qty), orderCount(count) {}
+};
+
+// Levels-only book for feed handlers. Same top-of-book / depth queries as
+// OrderBook, but no Order objects or order index: each side is a flat
+// sorted vector with the best price at the back, so updates near the
+// touch (the common case) move little or no memory.
+class MarketByPriceBook {
+private:
+    // Bids ascending, asks descending: back() is always the best level
+    std::vector<LevelSummary> bids;
+    std::vector<LevelSummary> asks;
+
+public:
+    explicit MarketByPriceBook(size_t expectedLevels = 64) {
+        bids.reserve(expectedLevels);
+        asks.reserve(expectedLevels);
+    }
+
+    // Insert or replace a level. A zero quantity deletes it.
+    void applyLevelUpdate(OrderSide side, uint32_t price, uint32_t quantity, uint32_t orderCount) {
+        if (quantity == 0) {
+            applyLevelDelete(side, price);
+            return;
+        }
+
+        auto& levels = (side == OrderSide::BUY) ? bids : asks;
+        auto it = findLevel(side, price);
+        if (it != levels.end() && it->price == price) {
+            it->quantity = quantity;
+            it->orderCount = orderCount;
+        } else {
+            levels.emplace(it, price, quantity, orderCount);
+        }
+    }
+
+    // Remove a level; returns false if it was not present
+    bool applyLevelDelete(OrderSide side, uint32_t price) {
+        auto& levels = (side == OrderSide::BUY) ? bids : asks;
+        auto it = findLevel(side, price);
+        if (it == levels.end() || it->price != price) {
+            return false;
+        }
+        levels.erase(it);
+        return true;
+    }
+
+    void reset() {
+        bids.clear();
+        asks.clear();
+    }
+
+    // Get best bid price
+    uint32_t getBestBid() const {
+        return bids.empty() ? 0 : bids.back().price;
+    }
+
+    // Get best ask price
+    uint32_t getBestAsk() const {
+        return asks.empty() ? 0 : asks.back().price;
+    }
+
+    uint32_t getBestBidQuantity() const { return bids.empty() ? 0 : bids.back().quantity; }
+    uint32_t getBestAskQuantity() const { return asks.empty() ? 0 : asks.back().quantity; }
+
+    // Get bid-ask spread
+    int32_t getSpread() const {
+        if (bids.empty() || asks.empty()) return -1;
+        return static_cast<int32_t>(getBestAsk() - getBestBid());
+    }
+
+    // Get order book depth
+    size_t getBidDepth() const { return bids.size(); }
+    size_t getAskDepth() const { return asks.size(); }
+
+    // Level by distance from the touch (0 = best); nullptr past the end
+    const LevelSummary* getLevel(OrderSide side, size_t depth) const {
+        const auto& levels = (side == OrderSide::BUY) ? bids : asks;
+        return depth < levels.size() ? &levels[levels.size() - 1 - depth] : nullptr;
+    }
+
+    // Print order book snapshot
+    void printBook(int levels = 5) const {
+        std::cout << "\n========== MBP BOOK ==========\n";
+        std::cout << "   ASKS (Sell Levels)\n";
+        std::cout << "Price\t\tQuantity\tOrders\n";
+        std::cout << "-----\t\t--------\t------\n";
+
+        int shown = std::min<int>(levels, static_cast<int>(asks.size()));
+        for (int i = shown - 1; i >= 0; --i) {
+            const auto& level = asks[asks.size() - 1 - i];
+            std::cout << level.price << "\t\t" << level.quantity << "\t\t" << level.orderCount << "\n";
+        }
+
+        std::cout << "\nSpread: " << getSpread() << "\n\n";
+
+        shown = std::min<int>(levels, static_cast<int>(bids.size()));
+        for (int i = 0; i < shown; ++i) {
+            const auto& level = bids[bids.size() - 1 - i];
+            std::cout << level.price << "\t\t" << level.quantity << "\t\t" << level.orderCount << "\n";
+        }
+
+        std::cout << "   BIDS (Buy Levels)\n";
+        std::cout << "==============================\n";
+    }
+
+private:
+    // Slot where `price` is, or would be inserted to keep the side sorted.
+    // Scans from the touch: feed updates cluster near the best price, so
+    // this beats a binary search and its unpredictable branches.
+    std::vector<LevelSummary>::iterator findLevel(OrderSide side, uint32_t price) {
+        auto& levels = (side == OrderSide::BUY) ? bids : asks;
+        size_t i = levels.size();
+        if (side == OrderSide::BUY) {
+            while (i > 0 && levels[i - 1].price > price) --i;
+        } else {
+            while (i > 0 && levels[i - 1].price < price) --i;
+        }
+        // Step onto an exact match, which sits just below the insert point
+        if (i > 0 && levels[i - 1].price == price) --i;
+        return levels.begin() + i;
+    }
+};
+
+} // namespace HFT
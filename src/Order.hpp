@@ -12,7 +12,14 @@ enum class OrderSide : uint8_t {
 
 enum class OrderType : uint8_t {
     LIMIT = 0,
-    MARKET = 1
+    MARKET = 1,
+    POST_ONLY = 2    // Limit order rejected if it would take liquidity
+};
+
+enum class TimeInForce : uint8_t {
+    GTC = 0,         // Rest until filled or cancelled
+    IOC = 1,         // Fill what crosses, cancel the rest
+    FOK = 2          // Fill completely on arrival or reject
 };
 
 enum class OrderStatus : uint8_t {
@@ -32,15 +39,19 @@ struct Order {
     OrderSide side;
     OrderType type;
     OrderStatus status;
+    TimeInForce timeInForce;
+    uint32_t handleSlot;     // Owning book's handle slot while resting; 0 = none
     
     Order() : orderId(0), timestamp(0), price(0), quantity(0), 
               filledQuantity(0), side(OrderSide::BUY), 
-              type(OrderType::LIMIT), status(OrderStatus::NEW) {}
+              type(OrderType::LIMIT), status(OrderStatus::NEW),
+              timeInForce(TimeInForce::GTC), handleSlot(0) {}
     
-    Order(uint64_t id, uint64_t ts, uint32_t p, uint32_t qty, OrderSide s)
+    Order(uint64_t id, uint64_t ts, uint32_t p, uint32_t qty, OrderSide s,
+          OrderType t = OrderType::LIMIT, TimeInForce tif = TimeInForce::GTC)
         : orderId(id), timestamp(ts), price(p), quantity(qty),
-          filledQuantity(0), side(s), type(OrderType::LIMIT), 
-          status(OrderStatus::NEW) {}
+          filledQuantity(0), side(s), type(t), 
+          status(OrderStatus::NEW), timeInForce(tif), handleSlot(0) {}
     
     uint32_t getRemainingQuantity() const {
         return quantity - filledQuantity;
@@ -60,6 +71,21 @@ struct Order {
     }
 };
 
+// Zobrist-style per-order key: a strong 64-bit mix of the fields that
+// define resting state. XOR-ing keys in and out keeps book hashes O(1).
+inline uint64_t restingOrderHash(uint64_t orderId, uint32_t price, OrderSide side, uint32_t remaining) {
+    uint64_t x = orderId * 0x9E3779B97F4A7C15ull;
+    x ^= (static_cast<uint64_t>(price) << 1 | static_cast<uint64_t>(side)) * 0xC2B2AE3D27D4EB4Full;
+    x ^= static_cast<uint64_t>(remaining) * 0x165667B19E3779F9ull;
+    // splitmix64 finalizer
+    x ^= x >> 30;
+    x *= 0xBF58476D1CE4E5B9ull;
+    x ^= x >> 27;
+    x *= 0x94D049BB133111EBull;
+    x ^= x >> 31;
+    return x;
+}
+
 // Trade execution result
 struct Trade {
     uint64_t buyOrderId;
@@ -68,8 +94,58 @@ struct Trade {
     uint32_t quantity;
     uint64_t timestamp;
     
+    Trade() : buyOrderId(0), sellOrderId(0), price(0), quantity(0), timestamp(0) {}
+    
     Trade(uint64_t bid, uint64_t sid, uint32_t p, uint32_t qty, uint64_t ts)
         : buyOrderId(bid), sellOrderId(sid), price(p), quantity(qty), timestamp(ts) {}
 };
 
+// Per-order execution report, captured at fill time
+struct ExecutionReport {
+    uint64_t orderId;
+    uint64_t contraOrderId;
+    uint64_t timestamp;
+    uint32_t lastPrice;
+    uint32_t lastQuantity;
+    uint32_t cumQuantity;
+    uint32_t leavesQuantity;
+    OrderSide side;
+    OrderStatus status;
+    bool aggressor;
+    
+    ExecutionReport(const Order& order, uint64_t contraId, uint64_t ts, uint32_t p,
+                    uint32_t qty, bool isAggressor)
+        : orderId(order.orderId), contraOrderId(contraId), timestamp(ts), lastPrice(p),
+          lastQuantity(qty), cumQuantity(order.filledQuantity),
+          leavesQuantity(order.getRemainingQuantity()), side(order.side),
+          status(order.status), aggressor(isAggressor) {}
+};
+
+// One aggressor's executions against a single price level
+struct SweepSummary {
+    uint64_t aggressorOrderId;
+    uint64_t firstRestingOrderId;
+    uint64_t lastRestingOrderId;
+    uint64_t timestamp;
+    uint32_t price;
+    uint32_t totalQuantity;
+    uint32_t counterpartyCount;
+    uint32_t firstFillIndex;     // Index of the first SweepFill for this level
+    OrderSide aggressorSide;
+    
+    SweepSummary(uint64_t aggId, uint64_t firstId, uint64_t lastId, uint64_t ts, uint32_t p,
+                 uint32_t qty, uint32_t count, uint32_t fillIndex, OrderSide side)
+        : aggressorOrderId(aggId), firstRestingOrderId(firstId), lastRestingOrderId(lastId),
+          timestamp(ts), price(p), totalQuantity(qty), counterpartyCount(count),
+          firstFillIndex(fillIndex), aggressorSide(side) {}
+};
+
+// Compact per-fill detail backing a SweepSummary
+struct SweepFill {
+    uint64_t restingOrderId;
+    uint32_t quantity;
+    
+    SweepFill(uint64_t id, uint32_t qty) : restingOrderId(id), quantity(qty) {}
+};
+
 } // namespace HFT
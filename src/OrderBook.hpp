@@ -1,70 +1,192 @@
 #pragma once
 
 #include "Order.hpp"
+#include "OrderId.hpp"
+#include "TickerPlant.hpp"
+#include "BookSampler.hpp"
+#include "SlabPool.hpp"
+#include "TopOfBookTable.hpp"
 #include <map>
 #include <unordered_map>
 #include <list>
 #include <vector>
 #include <memory>
 #include <algorithm>
+#include <cassert>
+#include <cstring>
 #include <iostream>
 
 namespace HFT {
 
+using OrderQueue = std::list<std::shared_ptr<Order>, SlabAllocator<std::shared_ptr<Order>>>;
+
 // Price level containing orders at the same price
 struct PriceLevel {
     uint32_t price;
     uint32_t totalQuantity;
-    std::list<std::shared_ptr<Order>> orders; // FIFO for price-time priority
+    OrderQueue orders; // FIFO for price-time priority
     
-    PriceLevel(uint32_t p) : price(p), totalQuantity(0) {}
+    PriceLevel(uint32_t p, SlabPool* pool = nullptr)
+        : price(p), totalQuantity(0), orders(SlabAllocator<std::shared_ptr<Order>>(pool)) {}
     
     void addOrder(std::shared_ptr<Order> order) {
         orders.push_back(order);
         totalQuantity += order->getRemainingQuantity();
     }
     
-    void removeOrder(std::shared_ptr<Order> order) {
-        totalQuantity -= order->getRemainingQuantity();
-        orders.remove(order);
-    }
-    
     bool isEmpty() const {
         return orders.empty();
     }
 };
 
+// Opaque reference to a resting order for the book's own clients:
+// slot | generation << 32. Stale handles (order filled, cancelled or the
+// slot reused) fail the generation check. 0 is never a valid handle.
+using OrderHandle = uint64_t;
+constexpr OrderHandle INVALID_ORDER_HANDLE = 0;
+
 class OrderBook {
 private:
+    template <typename Compare>
+    using Ladder = std::map<uint32_t, std::shared_ptr<PriceLevel>, Compare,
+                            SlabAllocator<std::pair<const uint32_t, std::shared_ptr<PriceLevel>>>>;
+    using OrderIndex = std::unordered_map<uint64_t, std::shared_ptr<Order>, std::hash<uint64_t>,
+                                          std::equal_to<uint64_t>,
+                                          SlabAllocator<std::pair<const uint64_t, std::shared_ptr<Order>>>>;
+    
+    // Orders, levels and their tree / list / hash nodes; declared first so
+    // it outlives every container below
+    SlabPool pool;
+    
     // Bid side: higher prices first (descending)
-    std::map<uint32_t, std::shared_ptr<PriceLevel>, std::greater<uint32_t>> bids;
+    Ladder<std::greater<uint32_t>> bids{std::greater<uint32_t>(), Ladder<std::greater<uint32_t>>::allocator_type(&pool)};
     
     // Ask side: lower prices first (ascending)
-    std::map<uint32_t, std::shared_ptr<PriceLevel>, std::less<uint32_t>> asks;
+    Ladder<std::less<uint32_t>> asks{std::less<uint32_t>(), Ladder<std::less<uint32_t>>::allocator_type(&pool)};
+    
+    // Fast order lookup. Optional: with it disabled, orders rest only in
+    // their level queue and are reached through handles alone.
+    OrderIndex orderMap{0, std::hash<uint64_t>(), std::equal_to<uint64_t>(), OrderIndex::allocator_type(&pool)};
+    bool idIndexEnabled = true;
+    size_t restingOrders = 0;
     
-    // Fast order lookup
-    std::unordered_map<uint64_t, std::shared_ptr<Order>> orderMap;
+    // Handle slots: where each resting order sits, so handle operations
+    // (and cancels) unlink it without searching. Slot 0 is never used.
+    struct HandleSlot {
+        Order* order = nullptr;
+        PriceLevel* level = nullptr;
+        OrderQueue::iterator position;
+        uint32_t generation = 1;
+        bool indexed = false;    // Also in orderMap
+    };
+    std::vector<HandleSlot> handleSlots = std::vector<HandleSlot>(1);
+    std::vector<uint32_t> freeHandleSlots;
     
     // Trade callback
     std::vector<Trade> trades;
     
-    uint64_t nextOrderId = 1;
+    // Optional per-level sweep summaries with compact fill details
+    bool sweepSummariesEnabled = false;
+    std::vector<SweepSummary> sweepSummaries;
+    std::vector<SweepFill> sweepFills;
+    
+    // Optional dual-sided execution reports (aggressor + resting per fill),
+    // bounded by the capacity given at enable time
+    bool executionReportsEnabled = false;
+    std::vector<ExecutionReport> executionReports;
+    size_t executionReportCapacity = 0;
+    uint64_t overflowExecutionReports = 0;
+    
+    // Shard/book-encoded order IDs (see OrderId.hpp)
+    OrderIdGenerator idGenerator;
+    
+    // XOR of orderHash() over all resting orders, maintained incrementally
+    uint64_t stateHash = 0;
+    
+    // Optional manager-level top-of-book row, written on BBO change
+    TopOfBookTable* topOfBookTable = nullptr;
+    uint32_t topOfBookRow = 0;
+    TopOfBookQuote lastTopOfBook{};
+    
+    // Optional shared-memory depth slot, written when the top levels change
+    TickerPlant* tickerPlant = nullptr;
+    uint32_t tickerSlot = 0;
+    DepthQuote lastDepth{};
+    
+    // Optional research sampler, fed after every order that traded
+    BookSampler* sampler = nullptr;
+    uint32_t samplerInstrument = 0;
 
 public:
     OrderBook() = default;
     
-    // Add a new limit order
+    OrderBook(uint32_t shardId, uint32_t bookId) : idGenerator(shardId, bookId) {}
+    
+    // Add a new limit order. Returns 0 once the book's ID sequence is
+    // exhausted.
     uint64_t addOrder(uint32_t price, uint32_t quantity, OrderSide side, uint64_t timestamp) {
-        auto order = std::make_shared<Order>(nextOrderId++, timestamp, price, quantity, side);
-        orderMap[order->orderId] = order;
+        if (idGenerator.isExhausted()) {
+            return 0;
+        }
+        return addLimitOrder(idGenerator.next(), price, quantity, side, timestamp);
+    }
+    
+    // Add a limit order under a caller-supplied ID, e.g. the exchange's ID
+    // when rebuilding a book from an L3 feed, so later cancels and modifies
+    // can use it directly. A book fed this way should not also issue its own
+    // IDs. False if the ID is 0 or already resting.
+    bool addOrderWithId(uint64_t orderId, uint32_t price, uint32_t quantity, OrderSide side, uint64_t timestamp) {
+        if (orderId == OrderId::INVALID || orderMap.find(orderId) != orderMap.end()) {
+            return false;
+        }
+        addLimitOrder(orderId, price, quantity, side, timestamp);
+        return true;
+    }
+    
+    // Add an order of any type / time-in-force. Returns 0 if the order was
+    // rejected (post-only that would cross, FOK that cannot fill completely,
+    // ID sequence exhausted).
+    uint64_t addOrder(uint32_t price, uint32_t quantity, OrderSide side, uint64_t timestamp,
+                      OrderType type, TimeInForce tif = TimeInForce::GTC) {
+        assert(side <= OrderSide::SELL && type <= OrderType::POST_ONLY && tif <= TimeInForce::FOK);
+        if (idGenerator.isExhausted()) {
+            return 0;
+        }
+        auto order = newOrder(idGenerator.next(), timestamp, price, quantity, side, type, tif);
         
-        if (side == OrderSide::BUY) {
-            addBuyOrder(order);
+        Kernel kernel = kernelTable[static_cast<size_t>(side)][static_cast<size_t>(type)][static_cast<size_t>(tif)];
+        (this->*kernel)(order);
+        
+        onBookChanged(side, price, order->filledQuantity > 0, timestamp);
+        return order->status == OrderStatus::REJECTED ? 0 : order->orderId;
+    }
+    
+    // Same, also returning a handle to the order if it rests (else
+    // INVALID_ORDER_HANDLE) for cancelByHandle / modifyByHandle
+    uint64_t addOrderWithHandle(uint32_t price, uint32_t quantity, OrderSide side, uint64_t timestamp,
+                                OrderHandle& handle, OrderType type = OrderType::LIMIT,
+                                TimeInForce tif = TimeInForce::GTC) {
+        handle = INVALID_ORDER_HANDLE;
+        assert(side <= OrderSide::SELL && type <= OrderType::POST_ONLY && tif <= TimeInForce::FOK);
+        if (idGenerator.isExhausted()) {
+            return 0;
+        }
+        auto order = newOrder(idGenerator.next(), timestamp, price, quantity, side, type, tif);
+        
+        if (type == OrderType::LIMIT && tif == TimeInForce::GTC) {
+            if (side == OrderSide::BUY) {
+                processOrder<OrderSide::BUY, OrderType::LIMIT, TimeInForce::GTC>(order);
+            } else {
+                processOrder<OrderSide::SELL, OrderType::LIMIT, TimeInForce::GTC>(order);
+            }
         } else {
-            addSellOrder(order);
+            Kernel kernel = kernelTable[static_cast<size_t>(side)][static_cast<size_t>(type)][static_cast<size_t>(tif)];
+            (this->*kernel)(order);
         }
         
-        return order->orderId;
+        onBookChanged(side, price, order->filledQuantity > 0, timestamp);
+        handle = order->handleSlot ? makeHandle(order->handleSlot) : INVALID_ORDER_HANDLE;
+        return order->status == OrderStatus::REJECTED ? 0 : order->orderId;
     }
     
     // Cancel an order
@@ -79,38 +201,58 @@ public:
             return false;
         }
         
-        removeOrder(order);
+        stateHash ^= orderHash(*order);
+        unlinkResting(*order);
+        order->status = OrderStatus::CANCELLED;
+        orderMap.erase(it);
+        
+        onBookChanged(order->side, order->price, false);
+        return true;
+    }
+    
+    // Cancel through a handle from addOrderWithHandle. False if the handle
+    // is stale. With the ID index disabled (see enableIdIndex) this touches
+    // no hash table at all.
+    bool cancelByHandle(OrderHandle handle) {
+        Order* order = resolveHandle(handle);
+        if (!order) {
+            return false;
+        }
+        
+        stateHash ^= orderHash(*order);
+        OrderSide side = order->side;
+        uint32_t price = order->price;
+        uint64_t orderId = order->orderId;
+        bool indexed = handleSlots[order->handleSlot].indexed;
         order->status = OrderStatus::CANCELLED;
-        orderMap.erase(orderId);
+        unlinkResting(*order);     // Releases an unindexed order
+        if (indexed) {
+            orderMap.erase(orderId);
+        }
         
+        onBookChanged(side, price, false);
         return true;
     }
     
-    // Modify order quantity (cancel and replace)
+    // Modify order quantity (cancel and replace). False if the order is
+    // unknown or `newQuantity` does not exceed what has already filled.
     bool modifyOrder(uint64_t orderId, uint32_t newQuantity) {
         auto it = orderMap.find(orderId);
         if (it == orderMap.end()) {
             return false;
         }
         
-        auto order = it->second;
-        uint32_t oldQuantity = order->quantity;
-        order->quantity = newQuantity;
-        
-        // Update price level quantity
-        if (order->side == OrderSide::BUY) {
-            auto levelIt = bids.find(order->price);
-            if (levelIt != bids.end()) {
-                levelIt->second->totalQuantity += (newQuantity - oldQuantity);
-            }
-        } else {
-            auto levelIt = asks.find(order->price);
-            if (levelIt != asks.end()) {
-                levelIt->second->totalQuantity += (newQuantity - oldQuantity);
-            }
+        return modifyResting(*it->second, newQuantity);
+    }
+    
+    // Modify through a handle; false if the handle is stale or the new
+    // quantity is not above the filled quantity
+    bool modifyByHandle(OrderHandle handle, uint32_t newQuantity) {
+        Order* order = resolveHandle(handle);
+        if (!order) {
+            return false;
         }
-        
-        return true;
+        return modifyResting(*order, newQuantity);
     }
     
     // Get best bid price
@@ -132,10 +274,257 @@ public:
     // Get order book depth
     size_t getBidDepth() const { return bids.size(); }
     size_t getAskDepth() const { return asks.size(); }
+    size_t getOrderCount() const { return restingOrders; }
     
     // Get all trades executed
     const std::vector<Trade>& getTrades() const { return trades; }
     
+    // 64-bit hash of the resting book (side, price, order ID, remaining
+    // quantity per order). Updated in O(1) on every change, so this is free
+    // to call; equal books give equal hashes regardless of history.
+    uint64_t getStateHash() const { return stateHash; }
+    
+    // Best bid / ask price and level size; 0 for an empty side
+    TopOfBookQuote getTopOfBook() const {
+        TopOfBookQuote quote{};
+        if (!bids.empty()) {
+            quote.bidPrice = bids.begin()->first;
+            quote.bidQuantity = bids.begin()->second->totalQuantity;
+        }
+        if (!asks.empty()) {
+            quote.askPrice = asks.begin()->first;
+            quote.askQuantity = asks.begin()->second->totalQuantity;
+        }
+        return quote;
+    }
+    
+    // Best TICKER_DEPTH levels of each side
+    DepthQuote getDepthQuote() const {
+        DepthQuote quote{};
+        for (auto it = bids.begin(); it != bids.end() && quote.bidLevels < TICKER_DEPTH; ++it, ++quote.bidLevels) {
+            quote.bidPrice[quote.bidLevels] = it->first;
+            quote.bidQuantity[quote.bidLevels] = it->second->totalQuantity;
+        }
+        for (auto it = asks.begin(); it != asks.end() && quote.askLevels < TICKER_DEPTH; ++it, ++quote.askLevels) {
+            quote.askPrice[quote.askLevels] = it->first;
+            quote.askQuantity[quote.askLevels] = it->second->totalQuantity;
+        }
+        return quote;
+    }
+    
+    // Best `maxLevels` levels of `side` into two parallel arrays, best
+    // first; unused entries are zeroed. Returns the levels copied.
+    uint32_t copyDepth(OrderSide side, uint32_t* prices, uint32_t* quantities, uint32_t maxLevels) const {
+        uint32_t count = side == OrderSide::BUY ? copyLevels(bids, prices, quantities, maxLevels)
+                                                : copyLevels(asks, prices, quantities, maxLevels);
+        std::memset(prices + count, 0, (maxLevels - count) * sizeof(uint32_t));
+        std::memset(quantities + count, 0, (maxLevels - count) * sizeof(uint32_t));
+        return count;
+    }
+    
+    // Let `grower` pre-map this book's pool slabs in the background and
+    // release them after sustained low occupancy (nullptr = grow inline).
+    // The grower must outlive the book or be detached first.
+    void attachPoolGrower(SlabGrower* grower) { pool.setGrower(grower); }
+    
+    const SlabPool& getPool() const { return pool; }
+    
+    // Enter orders that rest from now on in the order-ID index (default).
+    // Disabled, cancelOrder / modifyOrder cannot find them, but resting and
+    // handle operations skip the hash table entirely. Orders already
+    // indexed stay indexed.
+    void enableIdIndex(bool enabled) { idIndexEnabled = enabled; }
+    
+    // Sample this book into `sampler` (as `instrumentId`) after every order
+    // that trades; timer samples are driven by the caller
+    void attachSampler(BookSampler* bookSampler, uint32_t instrumentId) {
+        sampler = bookSampler;
+        samplerInstrument = instrumentId;
+    }
+    
+    // Publish this book's depth to slot `slot` of `plant` whenever any of
+    // the top levels changes
+    void attachTickerPlant(TickerPlant* plant, uint32_t slot) {
+        tickerPlant = plant;
+        tickerSlot = slot;
+        if (plant) {
+            lastDepth = getDepthQuote();
+            plant->publish(slot, lastDepth);
+        }
+    }
+    
+    // Keep row `row` of `table` current. The row is written after any
+    // operation that changes the best price or size on either side.
+    void attachTopOfBook(TopOfBookTable* table, uint32_t row) {
+        topOfBookTable = table;
+        topOfBookRow = row;
+        if (table) {
+            lastTopOfBook = getTopOfBook();
+            table->update(row, lastTopOfBook);
+        }
+    }
+    
+    // Sweep summaries: one record per aggressor per price level it trades at
+    void enableSweepSummaries(bool enabled) { sweepSummariesEnabled = enabled; }
+    const std::vector<SweepSummary>& getSweepSummaries() const { return sweepSummaries; }
+    const std::vector<SweepFill>& getSweepFills() const { return sweepFills; }
+    
+    // Drop consumed summaries and fills; capacity is kept
+    void clearSweepSummaries() {
+        sweepSummaries.clear();
+        sweepFills.clear();
+    }
+    
+    // Execution reports: two per fill, written into a buffer preallocated for
+    // `capacity` reports. Consumers drain it and call clearExecutionReports().
+    // A fill is never lost: a consumer that falls behind makes the buffer
+    // grow on the matching path, and every report written past `capacity`
+    // is counted in getExecutionReportOverflow() so the lag is visible.
+    void enableExecutionReports(bool enabled, size_t capacity = 65536) {
+        executionReportsEnabled = enabled;
+        if (enabled) {
+            executionReports.reserve(capacity);
+            executionReportCapacity = capacity;
+        }
+    }
+    const std::vector<ExecutionReport>& getExecutionReports() const { return executionReports; }
+    void clearExecutionReports() { executionReports.clear(); }
+    uint64_t getExecutionReportOverflow() const { return overflowExecutionReports; }
+    
+    // Clear all trading state; container capacity is kept
+    void reset() {
+        // Outstanding handles must go stale, so slots are released, not dropped
+        for (uint32_t slot = 1; slot < handleSlots.size(); ++slot) {
+            if (handleSlots[slot].order) {
+                releaseHandle(slot);
+            }
+        }
+        bids.clear();
+        asks.clear();
+        orderMap.clear();
+        restingOrders = 0;
+        trades.clear();
+        stateHash = 0;
+        clearSweepSummaries();
+        clearExecutionReports();
+        overflowExecutionReports = 0;
+        idGenerator.reset();
+        onBookChanged();
+    }
+    
+    // Copy resting orders in priority order: bids best first, then asks best
+    // first, FIFO within each level. Restoring them in this order rebuilds
+    // the same queues.
+    void captureSnapshot(std::vector<Order>& out) const {
+        out.clear();
+        out.reserve(restingOrders);
+        for (const auto& [price, level] : bids) {
+            for (const auto& order : level->orders) {
+                out.push_back(*order);
+            }
+        }
+        for (const auto& [price, level] : asks) {
+            for (const auto& order : level->orders) {
+                out.push_back(*order);
+            }
+        }
+    }
+    
+    // Next order ID sequence this book will issue
+    uint64_t getNextOrderSequence() const { return idGenerator.getNextSequence(); }
+    
+    // Replace the book with a captured snapshot. Trades and reports start
+    // empty; the ID generator resumes where the snapshot left off.
+    void restoreSnapshot(const Order* orders, size_t count, uint64_t nextSequence) {
+        reset();
+        for (size_t i = 0; i < count; ++i) {
+            auto order = newOrder(orders[i]);
+            auto& priceLevel = (order->side == OrderSide::BUY) ? bids[order->price] : asks[order->price];
+            if (!priceLevel) {
+                priceLevel = newLevel(order->price);
+            }
+            priceLevel->addOrder(order);
+            rest(order, *priceLevel);
+        }
+        idGenerator.resume(nextSequence);
+        onBookChanged();
+    }
+    
+    // Pre-open warm-up. Pre-sizes and touches this book's indexes, then
+    // rests `expectedOrders` in a shadow book and runs synthetic
+    // add/match/cancel traffic through it so the code paths and branch
+    // predictors are hot before the first live order. The shadow's pool
+    // profiles the load: this book's pool then maps and pre-faults as many
+    // blocks per size class, so resting that many orders here takes no
+    // slab growth or page faults. The shadow is reset afterwards; no book
+    // state leaks here.
+    void warmUp(uint32_t expectedOrders = 100000, uint32_t iterations = 50000) {
+        orderMap.reserve(expectedOrders);
+        handleSlots.reserve(expectedOrders + 1);
+        freeHandleSlots.reserve(expectedOrders);
+        
+        // Fault in the trade buffer through a scratch vector, then carry any
+        // trades already recorded over into it
+        std::vector<Trade> warmTrades;
+        warmTrades.reserve(trades.size() + expectedOrders);
+        while (warmTrades.size() < warmTrades.capacity()) {
+            warmTrades.emplace_back(0, 0, 0, 0, 0);
+        }
+        warmTrades.assign(trades.begin(), trades.end());
+        trades.swap(warmTrades);
+        
+        OrderBook shadow;
+        shadow.orderMap.reserve(expectedOrders);
+        
+        const uint32_t midPrice = 10000;
+        uint32_t seed = 0x9E3779B9u;
+        std::vector<uint64_t> resting;
+        resting.reserve(size_t(expectedOrders) + iterations);
+        
+        // The expected resting load, spread over the levels either side
+        for (uint32_t i = 0; i < expectedOrders; ++i) {
+            seed = seed * 1664525u + 1013904223u;
+            uint32_t offset = (seed >> 8) % 32;
+            OrderSide side = (seed & 1) ? OrderSide::BUY : OrderSide::SELL;
+            uint32_t price = (side == OrderSide::BUY) ? midPrice - 1 - offset : midPrice + 1 + offset;
+            resting.push_back(shadow.addOrder(price, 1 + ((seed >> 16) % 200), side, i));
+        }
+        
+        for (uint32_t i = 0; i < iterations; ++i) {
+            seed = seed * 1664525u + 1013904223u;
+            uint32_t offset = (seed >> 8) % 32;
+            uint32_t qty = 1 + ((seed >> 16) % 200);
+            OrderSide side = (seed & 1) ? OrderSide::BUY : OrderSide::SELL;
+            
+            switch (i % 4) {
+            case 0:
+            case 1: {
+                // Passive order on its own side of the mid
+                uint32_t price = (side == OrderSide::BUY) ? midPrice - 1 - offset : midPrice + 1 + offset;
+                resting.push_back(shadow.addOrder(price, qty, side, i));
+                break;
+            }
+            case 2: {
+                // Aggressive order crossing a few levels
+                uint32_t price = (side == OrderSide::BUY) ? midPrice + 1 + offset / 4 : midPrice - 1 - offset / 4;
+                shadow.addOrder(price, qty, side, i);
+                break;
+            }
+            default:
+                if (!resting.empty()) {
+                    size_t idx = seed % resting.size();
+                    shadow.cancelOrder(resting[idx]);
+                    resting[idx] = resting.back();
+                    resting.pop_back();
+                }
+                break;
+            }
+        }
+        
+        pool.reserveLike(shadow.pool);
+        shadow.reset();
+    }
+    
     // Print order book snapshot
     void printBook(int levels = 5) const {
         std::cout << "\n========== ORDER BOOK ==========\n";
@@ -160,65 +549,129 @@ public:
     }
 
 private:
-    void addBuyOrder(std::shared_ptr<Order> order) {
-        // Try to match with existing sell orders
-        while (!order->isFilled() && !asks.empty()) {
-            auto& bestAsk = asks.begin()->second;
-            
-            // Check if price crosses
-            if (order->price < bestAsk->price) {
-                break;
-            }
-            
-            // Match orders
-            matchOrders(order, bestAsk);
-            
-            // Remove empty price level
-            if (bestAsk->isEmpty()) {
-                asks.erase(asks.begin());
+    using Kernel = void (OrderBook::*)(const std::shared_ptr<Order>&);
+    
+    uint64_t addLimitOrder(uint64_t orderId, uint32_t price, uint32_t quantity, OrderSide side, uint64_t timestamp) {
+        auto order = newOrder(orderId, timestamp, price, quantity, side);
+        
+        // Plain GTC limit orders bypass the dispatch table entirely
+        if (side == OrderSide::BUY) {
+            processOrder<OrderSide::BUY, OrderType::LIMIT, TimeInForce::GTC>(order);
+        } else {
+            processOrder<OrderSide::SELL, OrderType::LIMIT, TimeInForce::GTC>(order);
+        }
+        
+        onBookChanged(side, price, order->filledQuantity > 0, timestamp);
+        return order->orderId;
+    }
+    
+    // Matching kernels indexed by [side][type][time-in-force]
+    static const Kernel kernelTable[2][3][3];
+    
+    // Per-side ladder selection and crossing test, resolved at compile time
+    template <OrderSide Side>
+    auto& oppositeLadder() {
+        if constexpr (Side == OrderSide::BUY) return asks; else return bids;
+    }
+    
+    template <OrderSide Side>
+    const auto& oppositeLadder() const {
+        if constexpr (Side == OrderSide::BUY) return asks; else return bids;
+    }
+    
+    template <OrderSide Side>
+    auto& ownLadder() {
+        if constexpr (Side == OrderSide::BUY) return bids; else return asks;
+    }
+    
+    template <OrderSide Side>
+    static bool crosses(uint32_t price, uint32_t restingPrice) {
+        if constexpr (Side == OrderSide::BUY) return price >= restingPrice; else return price <= restingPrice;
+    }
+    
+    // Single matching core for every side / type / time-in-force. All
+    // branches on Type and Tif are resolved at compile time, so plain
+    // limit orders carry none of the extra checks.
+    template <OrderSide Side, OrderType Type, TimeInForce Tif>
+    void processOrder(const std::shared_ptr<Order>& order) {
+        auto& opposite = oppositeLadder<Side>();
+        
+        if constexpr (Type == OrderType::POST_ONLY) {
+            if (!opposite.empty() && crosses<Side>(order->price, opposite.begin()->first)) {
+                order->status = OrderStatus::REJECTED;
+                return;
             }
         }
         
-        // If order not fully filled, add to book
-        if (!order->isFilled()) {
-            auto& priceLevel = bids[order->price];
-            if (!priceLevel) {
-                priceLevel = std::make_shared<PriceLevel>(order->price);
+        if constexpr (Tif == TimeInForce::FOK) {
+            if (!canFillCompletely<Side, Type>(*order)) {
+                order->status = OrderStatus::REJECTED;
+                return;
             }
-            priceLevel->addOrder(order);
         }
-    }
-    
-    void addSellOrder(std::shared_ptr<Order> order) {
-        // Try to match with existing buy orders
-        while (!order->isFilled() && !bids.empty()) {
-            auto& bestBid = bids.begin()->second;
+        
+        // Try to match with the opposite side
+        while (!order->isFilled() && !opposite.empty()) {
+            auto& bestLevel = opposite.begin()->second;
             
             // Check if price crosses
-            if (order->price > bestBid->price) {
-                break;
+            if constexpr (Type != OrderType::MARKET) {
+                if (!crosses<Side>(order->price, bestLevel->price)) {
+                    break;
+                }
             }
             
             // Match orders
-            matchOrders(order, bestBid);
+            matchOrders(order, bestLevel);
             
             // Remove empty price level
-            if (bestBid->isEmpty()) {
-                bids.erase(bids.begin());
+            if (bestLevel->isEmpty()) {
+                opposite.erase(opposite.begin());
             }
         }
         
-        // If order not fully filled, add to book
-        if (!order->isFilled()) {
-            auto& priceLevel = asks[order->price];
+        if (order->isFilled()) {
+            return;
+        }
+        
+        // Market and IOC remainders never rest
+        if constexpr (Type == OrderType::MARKET || Tif != TimeInForce::GTC) {
+            order->status = OrderStatus::CANCELLED;
+        } else {
+            auto& priceLevel = ownLadder<Side>()[order->price];
             if (!priceLevel) {
-                priceLevel = std::make_shared<PriceLevel>(order->price);
+                priceLevel = newLevel(order->price);
             }
             priceLevel->addOrder(order);
+            rest(order, *priceLevel);
         }
     }
     
-    void matchOrders(std::shared_ptr<Order> incomingOrder, std::shared_ptr<PriceLevel> priceLevel) {
+    // FOK pre-check: is there enough crossing quantity on the opposite side?
+    template <OrderSide Side, OrderType Type>
+    bool canFillCompletely(const Order& order) const {
+        uint64_t available = 0;
+        for (const auto& [price, level] : oppositeLadder<Side>()) {
+            if constexpr (Type != OrderType::MARKET) {
+                if (!crosses<Side>(order.price, price)) {
+                    break;
+                }
+            }
+            available += level->totalQuantity;
+            if (available >= order.quantity) {
+                return true;
+            }
+        }
+        return false;
+    }
+    
+    void matchOrders(const std::shared_ptr<Order>& incomingOrder, const std::shared_ptr<PriceLevel>& priceLevel) {
+        const uint32_t firstFillIndex = static_cast<uint32_t>(sweepFills.size());
+        const uint64_t firstRestingId = priceLevel->orders.front()->orderId;
+        uint64_t lastRestingId = firstRestingId;
+        uint32_t levelQuantity = 0;
+        uint32_t counterparties = 0;
+        
         while (!incomingOrder->isFilled() && !priceLevel->isEmpty()) {
             auto restingOrder = priceLevel->orders.front();
             
@@ -226,8 +679,10 @@ private:
                                          restingOrder->getRemainingQuantity());
             
             // Execute trade
+            stateHash ^= orderHash(*restingOrder);
             incomingOrder->fill(tradeQty);
             restingOrder->fill(tradeQty);
+            priceLevel->totalQuantity -= tradeQty;
             
             // Record trade
             uint64_t buyId = (incomingOrder->side == OrderSide::BUY) ? incomingOrder->orderId : restingOrder->orderId;
@@ -235,33 +690,217 @@ private:
             
             trades.emplace_back(buyId, sellId, restingOrder->price, tradeQty, incomingOrder->timestamp);
             
+            if (executionReportsEnabled) {
+                if (executionReports.size() + 2 > executionReportCapacity) {
+                    overflowExecutionReports += 2;
+                }
+                executionReports.emplace_back(*incomingOrder, restingOrder->orderId, incomingOrder->timestamp,
+                                              restingOrder->price, tradeQty, true);
+                executionReports.emplace_back(*restingOrder, incomingOrder->orderId, incomingOrder->timestamp,
+                                              restingOrder->price, tradeQty, false);
+            }
+            
+            if (sweepSummariesEnabled) {
+                sweepFills.emplace_back(restingOrder->orderId, tradeQty);
+                lastRestingId = restingOrder->orderId;
+                levelQuantity += tradeQty;
+                ++counterparties;
+            }
+            
             // Remove filled order from price level
             if (restingOrder->isFilled()) {
-                priceLevel->removeOrder(restingOrder);
-                orderMap.erase(restingOrder->orderId);
+                bool indexed = handleSlots[restingOrder->handleSlot].indexed;
+                releaseHandle(restingOrder->handleSlot);
+                priceLevel->orders.pop_front();
+                if (indexed) {
+                    orderMap.erase(restingOrder->orderId);
+                }
+            } else {
+                stateHash ^= orderHash(*restingOrder);
             }
         }
+        
+        if (sweepSummariesEnabled && counterparties > 0) {
+            sweepSummaries.emplace_back(incomingOrder->orderId, firstRestingId, lastRestingId,
+                                        incomingOrder->timestamp, priceLevel->price, levelQuantity,
+                                        counterparties, firstFillIndex, incomingOrder->side);
+        }
     }
     
-    void removeOrder(std::shared_ptr<Order> order) {
-        if (order->side == OrderSide::BUY) {
-            auto levelIt = bids.find(order->price);
-            if (levelIt != bids.end()) {
-                levelIt->second->removeOrder(order);
-                if (levelIt->second->isEmpty()) {
-                    bids.erase(levelIt);
-                }
+    // Post-operation hook for derived views of the book
+    void onBookChanged() {
+        refreshTopOfBook();
+        if (tickerPlant) {
+            publishDepth();
+        }
+    }
+    
+    // Same, for an operation that touched one level on `side` at `price`
+    // (and the opposite side's best levels if it `matched`). Changes below
+    // the published depth skip the level walk. `timestamp` stamps the trade
+    // sample of a matched order.
+    void onBookChanged(OrderSide side, uint32_t price, bool matched, uint64_t timestamp = 0) {
+        refreshTopOfBook();
+        if (tickerPlant && (matched || withinPublishedDepth(side, price))) {
+            publishDepth();
+        }
+        if (sampler && matched) {
+            sampler->sample(*this, samplerInstrument, timestamp, SampleTrigger::TRADE);
+        }
+    }
+    
+    void refreshTopOfBook() {
+        if (topOfBookTable) {
+            TopOfBookQuote quote = getTopOfBook();
+            if (quote != lastTopOfBook) {
+                lastTopOfBook = quote;
+                topOfBookTable->update(topOfBookRow, quote);
             }
+        }
+    }
+    
+    bool withinPublishedDepth(OrderSide side, uint32_t price) const {
+        if (side == OrderSide::BUY) {
+            return lastDepth.bidLevels < TICKER_DEPTH || price >= lastDepth.bidPrice[TICKER_DEPTH - 1];
+        }
+        return lastDepth.askLevels < TICKER_DEPTH || price <= lastDepth.askPrice[TICKER_DEPTH - 1];
+    }
+    
+    void publishDepth() {
+        DepthQuote depth = getDepthQuote();
+        if (std::memcmp(&depth, &lastDepth, sizeof(DepthQuote)) != 0) {
+            lastDepth = depth;
+            tickerPlant->publish(tickerSlot, depth);
+        }
+    }
+    
+    template <typename Levels>
+    static uint32_t copyLevels(const Levels& levels, uint32_t* prices, uint32_t* quantities, uint32_t maxLevels) {
+        uint32_t count = 0;
+        for (auto it = levels.begin(); it != levels.end() && count < maxLevels; ++it, ++count) {
+            prices[count] = it->first;
+            quantities[count] = it->second->totalQuantity;
+        }
+        return count;
+    }
+    
+    template <typename... Args>
+    std::shared_ptr<Order> newOrder(Args&&... args) {
+        return std::allocate_shared<Order>(SlabAllocator<Order>(&pool), std::forward<Args>(args)...);
+    }
+    
+    std::shared_ptr<PriceLevel> newLevel(uint32_t price) {
+        return std::allocate_shared<PriceLevel>(SlabAllocator<PriceLevel>(&pool), price, &pool);
+    }
+    
+    static uint64_t orderHash(const Order& order) {
+        return restingOrderHash(order.orderId, order.price, order.side, order.getRemainingQuantity());
+    }
+    
+    OrderHandle makeHandle(uint32_t slot) const {
+        return slot | (static_cast<uint64_t>(handleSlots[slot].generation) << 32);
+    }
+    
+    Order* resolveHandle(OrderHandle handle) const {
+        uint32_t slot = static_cast<uint32_t>(handle);
+        if (slot == 0 || slot >= handleSlots.size()) {
+            return nullptr;
+        }
+        const HandleSlot& entry = handleSlots[slot];
+        return entry.generation == static_cast<uint32_t>(handle >> 32) ? entry.order : nullptr;
+    }
+    
+    // Index and hash an order just added to the back of `level`
+    void rest(const std::shared_ptr<Order>& order, PriceLevel& level) {
+        acquireHandle(*order, level);
+        if (idIndexEnabled) {
+            orderMap[order->orderId] = order;
+            handleSlots[order->handleSlot].indexed = true;
+        }
+        stateHash ^= orderHash(*order);
+    }
+    
+    // Record where a just-rested order sits (the back of `level`)
+    void acquireHandle(Order& order, PriceLevel& level) {
+        uint32_t slot;
+        if (!freeHandleSlots.empty()) {
+            slot = freeHandleSlots.back();
+            freeHandleSlots.pop_back();
         } else {
-            auto levelIt = asks.find(order->price);
-            if (levelIt != asks.end()) {
-                levelIt->second->removeOrder(order);
-                if (levelIt->second->isEmpty()) {
-                    asks.erase(levelIt);
-                }
+            slot = static_cast<uint32_t>(handleSlots.size());
+            handleSlots.emplace_back();
+        }
+        HandleSlot& entry = handleSlots[slot];
+        entry.order = &order;
+        entry.level = &level;
+        entry.position = std::prev(level.orders.end());
+        entry.indexed = false;
+        order.handleSlot = slot;
+        ++restingOrders;
+    }
+    
+    void releaseHandle(uint32_t slot) {
+        HandleSlot& entry = handleSlots[slot];
+        entry.order->handleSlot = 0;
+        entry.order = nullptr;
+        entry.level = nullptr;
+        --restingOrders;
+        if (++entry.generation == 0) {
+            entry.generation = 1;   // Keep 0 out of handles
+        }
+        freeHandleSlots.push_back(slot);
+    }
+    
+    // Take a resting order off its level in O(1), dropping the level if it
+    // empties. The caller owns the index entry.
+    void unlinkResting(Order& order) {
+        uint32_t slot = order.handleSlot;
+        PriceLevel* level = handleSlots[slot].level;
+        auto position = handleSlots[slot].position;
+        uint32_t price = order.price;
+        OrderSide side = order.side;
+        releaseHandle(slot);
+        
+        level->totalQuantity -= order.getRemainingQuantity();
+        level->orders.erase(position);   // May drop a reference to the order
+        if (level->isEmpty()) {
+            if (side == OrderSide::BUY) {
+                bids.erase(price);
+            } else {
+                asks.erase(price);
             }
         }
     }
+    
+    bool modifyResting(Order& order, uint32_t newQuantity) {
+        if (newQuantity <= order.filledQuantity) {
+            return false;
+        }
+        uint32_t oldQuantity = order.quantity;
+        stateHash ^= orderHash(order);
+        order.quantity = newQuantity;
+        stateHash ^= orderHash(order);
+        handleSlots[order.handleSlot].level->totalQuantity += (newQuantity - oldQuantity);
+        
+        onBookChanged(order.side, order.price, false);
+        return true;
+    }
+};
+
+#define HFT_KERNEL_ROW(side, type) \
+    { &OrderBook::processOrder<side, type, TimeInForce::GTC>, \
+      &OrderBook::processOrder<side, type, TimeInForce::IOC>, \
+      &OrderBook::processOrder<side, type, TimeInForce::FOK> }
+
+inline const OrderBook::Kernel OrderBook::kernelTable[2][3][3] = {
+    { HFT_KERNEL_ROW(OrderSide::BUY, OrderType::LIMIT),
+      HFT_KERNEL_ROW(OrderSide::BUY, OrderType::MARKET),
+      HFT_KERNEL_ROW(OrderSide::BUY, OrderType::POST_ONLY) },
+    { HFT_KERNEL_ROW(OrderSide::SELL, OrderType::LIMIT),
+      HFT_KERNEL_ROW(OrderSide::SELL, OrderType::MARKET),
+      HFT_KERNEL_ROW(OrderSide::SELL, OrderType::POST_ONLY) }
 };
 
+#undef HFT_KERNEL_ROW
+
 } // namespace HFT
@@ -0,0 +1,122 @@
+#pragma once
+
+#include "OrderBook.hpp"
+#include <cassert>
+#include <memory>
+#include <vector>
+
+namespace HFT {
+
+// Owns one order book per instrument, addressed by a dense instrument ID.
+// Each book issues IDs tagged with this manager's shard and its instrument
+// ID, so cancels and modifies route with a shift-and-mask. The books keep
+// a shared top-of-book table current for universe-wide scans.
+class OrderBookManager {
+private:
+    std::vector<std::unique_ptr<OrderBook>> books;
+    std::unique_ptr<TopOfBookTable> topOfBook = std::make_unique<TopOfBookTable>();
+    BookSampler* sampler = nullptr;
+    SlabGrower* poolGrower = nullptr;
+    uint32_t shardId;
+
+public:
+    explicit OrderBookManager(uint32_t shard = 0) : shardId(shard) {}
+
+    static constexpr uint32_t INVALID_INSTRUMENT = UINT32_MAX;
+
+    // Register a new instrument and return its ID, or INVALID_INSTRUMENT
+    // once every book number an order ID can carry is taken
+    uint32_t addInstrument() {
+        if (books.size() > OrderId::BOOK_MASK) {
+            assert(!"OrderBookManager: instrument IDs exhausted");
+            return INVALID_INSTRUMENT;
+        }
+        uint32_t instrumentId = static_cast<uint32_t>(books.size());
+        books.push_back(std::make_unique<OrderBook>(shardId, instrumentId));
+        topOfBook->resize(books.size());
+        books.back()->attachTopOfBook(topOfBook.get(), instrumentId);
+        if (sampler) {
+            books.back()->attachSampler(sampler, instrumentId);
+        }
+        if (poolGrower) {
+            books.back()->attachPoolGrower(poolGrower);
+        }
+        return instrumentId;
+    }
+
+    OrderBook& getBook(uint32_t instrumentId) { return *books[instrumentId]; }
+    const OrderBook& getBook(uint32_t instrumentId) const { return *books[instrumentId]; }
+
+    size_t getInstrumentCount() const { return books.size(); }
+
+    // Best bid / ask of every instrument, indexed by instrument ID
+    const TopOfBookTable& getTopOfBook() const { return *topOfBook; }
+    uint32_t getShardId() const { return shardId; }
+
+    // Route by the book encoded in the order ID
+    bool cancelOrder(uint64_t orderId) {
+        uint32_t book = OrderId::bookOf(orderId);
+        return book < books.size() && books[book]->cancelOrder(orderId);
+    }
+
+    bool modifyOrder(uint64_t orderId, uint32_t newQuantity) {
+        uint32_t book = OrderId::bookOf(orderId);
+        return book < books.size() && books[book]->modifyOrder(orderId, newQuantity);
+    }
+
+    // Publish every book's depth to `plant`, slot = instrument ID. The plant
+    // must have a slot per instrument; instruments added later are not
+    // attached.
+    void attachTickerPlant(TickerPlant* plant) {
+        for (uint32_t id = 0; id < books.size(); ++id) {
+            books[id]->attachTickerPlant(plant, id);
+        }
+    }
+
+    // Feed every book's trade samples to `sampler`, instrument = ID, and
+    // take timer samples of all books from pollSampler()
+    void attachSampler(BookSampler* bookSampler) {
+        sampler = bookSampler;
+        for (uint32_t id = 0; id < books.size(); ++id) {
+            books[id]->attachSampler(bookSampler, id);
+        }
+    }
+
+    // Engine loop: one timer sample per book when the period has elapsed
+    void pollSampler(uint64_t nowNs) {
+        if (sampler && sampler->timerDue(nowNs)) {
+            for (uint32_t id = 0; id < books.size(); ++id) {
+                sampler->sample(*books[id], id, nowNs, SampleTrigger::TIMER);
+            }
+        }
+    }
+
+    // Background slab growth for every book's pool (see SlabPool.hpp),
+    // including books added later
+    void attachPoolGrower(SlabGrower* grower) {
+        poolGrower = grower;
+        for (auto& book : books) {
+            book->attachPoolGrower(grower);
+        }
+    }
+
+    // Pre-open warm-up of every book (see OrderBook::warmUp). Indexes and
+    // pools are sized for `expectedOrders` resting across the whole
+    // manager, and `iterations` of synthetic traffic are run in total, both
+    // split evenly over the books, so neither memory nor pre-open time
+    // scales with the universe. The code paths are shared, so a few
+    // iterations per book keep them hot.
+    void warmUp(uint64_t expectedOrders = 100000, uint64_t iterations = 50000) {
+        if (books.empty()) {
+            return;
+        }
+        uint64_t ordersPerBook = std::max<uint64_t>(expectedOrders / books.size(), 1);
+        uint64_t iterationsPerBook = std::max<uint64_t>(iterations / books.size(), 1);
+        for (auto& book : books) {
+            book->warmUp(static_cast<uint32_t>(std::min<uint64_t>(ordersPerBook, UINT32_MAX)),
+                         static_cast<uint32_t>(std::min<uint64_t>(iterationsPerBook, UINT32_MAX)));
+        }
+    }
+};
+
+} // namespace HFT
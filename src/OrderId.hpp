@@ -0,0 +1,84 @@
+#pragma once
+
+#include <cassert>
+#include <cstdint>
+
+namespace HFT {
+
+// 64-bit order ID layout:
+//   [63..56] shard    (8 bits,  up to 256 matching shards)
+//   [55..40] book     (16 bits, up to 65536 books per shard)
+//   [39..0]  sequence (40 bits, ~1.1e12 orders per book)
+// Shard 0 / book 0 yields plain sequence numbers, so a standalone book
+// keeps issuing 1, 2, 3, ...
+namespace OrderId {
+
+constexpr uint32_t SEQUENCE_BITS = 40;
+constexpr uint32_t BOOK_BITS = 16;
+constexpr uint32_t SHARD_BITS = 8;
+
+constexpr uint32_t BOOK_SHIFT = SEQUENCE_BITS;
+constexpr uint32_t SHARD_SHIFT = SEQUENCE_BITS + BOOK_BITS;
+
+constexpr uint64_t SEQUENCE_MASK = (uint64_t(1) << SEQUENCE_BITS) - 1;
+constexpr uint64_t BOOK_MASK = (uint64_t(1) << BOOK_BITS) - 1;
+constexpr uint64_t SHARD_MASK = (uint64_t(1) << SHARD_BITS) - 1;
+
+// Never issued: every real ID has a sequence of at least 1
+constexpr uint64_t INVALID = 0;
+
+constexpr uint64_t encode(uint32_t shard, uint32_t book, uint64_t sequence) {
+    return (uint64_t(shard & SHARD_MASK) << SHARD_SHIFT) |
+           (uint64_t(book & BOOK_MASK) << BOOK_SHIFT) |
+           (sequence & SEQUENCE_MASK);
+}
+
+constexpr uint32_t shardOf(uint64_t orderId) {
+    return static_cast<uint32_t>((orderId >> SHARD_SHIFT) & SHARD_MASK);
+}
+
+constexpr uint32_t bookOf(uint64_t orderId) {
+    return static_cast<uint32_t>((orderId >> BOOK_SHIFT) & BOOK_MASK);
+}
+
+constexpr uint64_t sequenceOf(uint64_t orderId) {
+    return orderId & SEQUENCE_MASK;
+}
+
+} // namespace OrderId
+
+// Per-book ID generator. Owned by a single thread, so a plain increment of
+// the pre-encoded prefix is enough; no atomics needed. Once the 40-bit
+// sequence is used up next() returns OrderId::INVALID instead of wrapping
+// onto IDs already issued.
+class OrderIdGenerator {
+private:
+    uint64_t prefix;
+    uint64_t nextSequence = 1;
+
+public:
+    explicit OrderIdGenerator(uint32_t shard = 0, uint32_t book = 0)
+        : prefix(OrderId::encode(shard, book, 0)) {
+        assert(shard <= OrderId::SHARD_MASK && book <= OrderId::BOOK_MASK);
+    }
+
+    uint64_t next() {
+        if (nextSequence > OrderId::SEQUENCE_MASK) {
+            return OrderId::INVALID;
+        }
+        return prefix | nextSequence++;
+    }
+
+    bool isExhausted() const { return nextSequence > OrderId::SEQUENCE_MASK; }
+
+    void reset() { nextSequence = 1; }
+    
+    // Position of the generator, for snapshot / restore
+    uint64_t getNextSequence() const { return nextSequence; }
+    void resume(uint64_t sequence) { nextSequence = sequence; }
+
+    uint32_t getShard() const { return OrderId::shardOf(prefix); }
+    uint32_t getBook() const { return OrderId::bookOf(prefix); }
+};
+
+} // namespace HFT
@@ -0,0 +1,295 @@
+#pragma once
+
+// Hot-standby replication: the primary streams its sequenced commands to a
+// replica over loopback TCP; the replica applies them to its own book and
+// acknowledges by sequence number. POSIX sockets; Linux only.
+
+#include "Command.hpp"
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <memory>
+#include <thread>
+
+#include <arpa/inet.h>
+#include <cerrno>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+namespace HFT {
+
+// Primary -> replica frame: header followed by `count` raw Commands
+struct ReplicationFrameHeader {
+    uint32_t count;
+    uint32_t reserved;
+};
+
+namespace detail {
+
+inline bool sendAll(int fd, const void* data, size_t length) {
+    const char* p = static_cast<const char*>(data);
+    while (length > 0) {
+        ssize_t n = ::send(fd, p, length, MSG_NOSIGNAL);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        p += n;
+        length -= static_cast<size_t>(n);
+    }
+    return true;
+}
+
+inline bool recvAll(int fd, void* data, size_t length) {
+    char* p = static_cast<char*>(data);
+    while (length > 0) {
+        ssize_t n = ::recv(fd, p, length, 0);
+        if (n <= 0) {
+            if (n < 0 && errno == EINTR) continue;
+            return false;
+        }
+        p += n;
+        length -= static_cast<size_t>(n);
+    }
+    return true;
+}
+
+inline void setNoDelay(int fd) {
+    int one = 1;
+    ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+}
+
+} // namespace detail
+
+// Primary side. publish() only copies the command into an SPSC ring; a
+// sender thread batches the ring into frames and reads acknowledgements.
+// The primary never waits for the standby: a send that fails or times out
+// (replica dead or not reading), or a ring that fills up, marks the link
+// down, and from then on publish() only counts the commands it drops. The
+// caller watches isLinkUp() to fail over or re-seed a standby.
+class ReplicationPublisher {
+public:
+    static constexpr size_t MAX_BATCH = 1024;
+    static constexpr int SEND_TIMEOUT_MS = 1000;
+
+private:
+    std::unique_ptr<CommandQueue> ring = std::make_unique<CommandQueue>();
+    std::unique_ptr<Command[]> batch{new Command[MAX_BATCH]};
+    int fd = -1;
+    std::thread sender;
+    std::atomic<bool> running{false};
+    std::atomic<bool> linkUp{false};
+    std::atomic<uint64_t> ackedSequence{0};
+    std::atomic<uint64_t> droppedCommands{0};   // Written by publish() only
+
+public:
+    ReplicationPublisher() = default;
+    ReplicationPublisher(const ReplicationPublisher&) = delete;
+    ReplicationPublisher& operator=(const ReplicationPublisher&) = delete;
+    ~ReplicationPublisher() { stop(); }
+
+    // Connect to a replica on 127.0.0.1:port and start the sender thread
+    bool start(uint16_t port) {
+        fd = ::socket(AF_INET, SOCK_STREAM, 0);
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        addr.sin_port = htons(port);
+        if (fd < 0 || ::connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0) {
+            if (fd >= 0) {
+                ::close(fd);
+                fd = -1;
+            }
+            return false;
+        }
+        detail::setNoDelay(fd);
+        timeval sendTimeout{SEND_TIMEOUT_MS / 1000, (SEND_TIMEOUT_MS % 1000) * 1000};
+        ::setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &sendTimeout, sizeof(sendTimeout));
+
+        droppedCommands.store(0, std::memory_order_relaxed);
+        linkUp.store(true, std::memory_order_release);
+        running.store(true, std::memory_order_release);
+        sender = std::thread([this] { senderLoop(); });
+        return true;
+    }
+
+    // Flush what is queued (while the link is up), then disconnect
+    void stop() {
+        if (!running.exchange(false)) {
+            return;
+        }
+        sender.join();
+        linkUp.store(false, std::memory_order_release);
+        ::close(fd);
+        fd = -1;
+    }
+
+    // Critical path: one ring slot copy, never a wait. Returns false if the
+    // command was dropped because the link is (or just went) down.
+    bool publish(const Command& cmd) {
+        if (!linkUp.load(std::memory_order_acquire)) {
+            droppedCommands.store(droppedCommands.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+            return false;
+        }
+        if (!ring->tryPush(cmd)) {
+            // A whole ring behind: the standby is stalled
+            linkUp.store(false, std::memory_order_release);
+            droppedCommands.store(droppedCommands.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+            return false;
+        }
+        return true;
+    }
+
+    // False once the standby died, stalled or was stopped: it no longer
+    // holds the primary's stream
+    bool isLinkUp() const { return linkUp.load(std::memory_order_acquire); }
+    uint64_t getAckedSequence() const { return ackedSequence.load(std::memory_order_acquire); }
+    uint64_t getDroppedCommands() const { return droppedCommands.load(std::memory_order_relaxed); }
+
+    // Block until the replica has applied `sequence`; false on timeout or
+    // once the link is down
+    bool waitForAck(uint64_t sequence, std::chrono::milliseconds timeout) {
+        auto deadline = std::chrono::steady_clock::now() + timeout;
+        while (getAckedSequence() < sequence) {
+            if (!isLinkUp() || std::chrono::steady_clock::now() > deadline) {
+                return false;
+            }
+            std::this_thread::yield();
+        }
+        return true;
+    }
+
+private:
+    void senderLoop() {
+        for (;;) {
+            bool stopping = !running.load(std::memory_order_acquire);
+            size_t count = 0;
+            while (count < MAX_BATCH && ring->tryPop(batch[count])) {
+                ++count;
+            }
+
+            if (count > 0) {
+                ReplicationFrameHeader header{static_cast<uint32_t>(count), 0};
+                if (!detail::sendAll(fd, &header, sizeof(header)) ||
+                    !detail::sendAll(fd, batch.get(), count * sizeof(Command))) {
+                    linkUp.store(false, std::memory_order_release);
+                    return;
+                }
+            }
+
+            if (!readAcks()) {
+                linkUp.store(false, std::memory_order_release);
+                return;
+            }
+            if (!linkUp.load(std::memory_order_acquire)) {
+                return;   // publish() found the ring full
+            }
+
+            if (count == 0) {
+                if (stopping) {
+                    return;
+                }
+                std::this_thread::sleep_for(std::chrono::microseconds(20));
+            }
+        }
+    }
+
+    // False once the replica has closed or reset the connection
+    bool readAcks() {
+        uint64_t acks[64];
+        ssize_t n;
+        while ((n = ::recv(fd, acks, sizeof(acks), MSG_DONTWAIT)) > 0) {
+            // Acks are 8-byte sequence numbers; the last complete one wins
+            size_t complete = static_cast<size_t>(n) / sizeof(uint64_t);
+            if (complete > 0) {
+                ackedSequence.store(acks[complete - 1], std::memory_order_release);
+            }
+            if (n % sizeof(uint64_t) != 0) {
+                // Finish the partial ack so the stream stays aligned
+                size_t have = static_cast<size_t>(n) % sizeof(uint64_t);
+                uint64_t last = 0;
+                std::memcpy(&last, reinterpret_cast<char*>(acks) + complete * sizeof(uint64_t), have);
+                if (!detail::recvAll(fd, reinterpret_cast<char*>(&last) + have, sizeof(uint64_t) - have)) {
+                    return false;
+                }
+                ackedSequence.store(last, std::memory_order_release);
+            }
+        }
+        return n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR);
+    }
+};
+
+// Replica side. Applies each frame to its own book in sequence order and
+// acknowledges the last applied sequence once per frame. On failover the
+// book is already current, so there is nothing to replay.
+class ReplicaEngine {
+private:
+    OrderBook& book;
+    int listenFd = -1;
+    std::atomic<uint64_t> appliedSequence{0};
+    std::unique_ptr<Command[]> frame{new Command[ReplicationPublisher::MAX_BATCH]};
+
+public:
+    explicit ReplicaEngine(OrderBook& replicaBook) : book(replicaBook) {}
+    ReplicaEngine(const ReplicaEngine&) = delete;
+    ReplicaEngine& operator=(const ReplicaEngine&) = delete;
+    ~ReplicaEngine() {
+        if (listenFd >= 0) ::close(listenFd);
+    }
+
+    // Listen on 127.0.0.1:port (0 = ephemeral); returns the port or 0
+    uint16_t listen(uint16_t port) {
+        listenFd = ::socket(AF_INET, SOCK_STREAM, 0);
+        int one = 1;
+        ::setsockopt(listenFd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        addr.sin_port = htons(port);
+        if (::bind(listenFd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0 ||
+            ::listen(listenFd, 1) < 0) {
+            ::close(listenFd);
+            listenFd = -1;
+            return 0;
+        }
+        socklen_t len = sizeof(addr);
+        ::getsockname(listenFd, reinterpret_cast<sockaddr*>(&addr), &len);
+        return ntohs(addr.sin_port);
+    }
+
+    // Accept one primary and apply its stream until it disconnects
+    void run() {
+        int fd = ::accept(listenFd, nullptr, nullptr);
+        if (fd < 0) {
+            return;
+        }
+        detail::setNoDelay(fd);
+
+        ReplicationFrameHeader header;
+        while (detail::recvAll(fd, &header, sizeof(header))) {
+            if (header.count == 0) {
+                continue;
+            }
+            if (header.count > ReplicationPublisher::MAX_BATCH ||
+                !detail::recvAll(fd, frame.get(), header.count * sizeof(Command))) {
+                break;
+            }
+            for (uint32_t i = 0; i < header.count; ++i) {
+                applyCommand(book, frame[i]);
+            }
+            uint64_t last = frame[header.count - 1].sequence;
+            appliedSequence.store(last, std::memory_order_release);
+            if (!detail::sendAll(fd, &last, sizeof(last))) {
+                break;
+            }
+        }
+        ::close(fd);
+    }
+
+    uint64_t getAppliedSequence() const { return appliedSequence.load(std::memory_order_acquire); }
+};
+
+} // namespace HFT
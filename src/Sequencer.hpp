@@ -0,0 +1,70 @@
+#pragma once
+
+#include "Command.hpp"
+#include "Journal.hpp"
+#include <chrono>
+#include <vector>
+
+namespace HFT {
+
+// Merges per-gateway SPSC rings into one totally ordered command stream.
+// Each poll() visits the inputs round-robin and takes up to a batch from
+// each, so no gateway can starve the others. Every command gets the next
+// global sequence number and the batch's timestamp, is journaled, and is
+// then forwarded to the sink (typically the book shard's ring).
+template <typename Sink>
+class Sequencer {
+private:
+    std::vector<CommandQueue*> inputs;
+    Sink sink;
+    JournalWriter* journal = nullptr;
+    MessageTracer* tracer = nullptr;
+    uint64_t nextSequence = 1;
+
+public:
+    explicit Sequencer(Sink s) : sink(s) {}
+
+    void addInput(CommandQueue& queue) { inputs.push_back(&queue); }
+
+    // Journal every sequenced command before it is forwarded
+    void setJournal(JournalWriter* writer) { journal = writer; }
+
+    // Stamp the sequence stage of traced commands
+    void setTracer(MessageTracer* t) { tracer = t; }
+
+    // One merge pass; returns the number of commands sequenced
+    size_t poll(size_t maxBatchPerInput = 256) {
+        // One clock read per pass: commands in a pass share a timestamp
+        const uint64_t timestamp = static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count());
+
+        size_t total = 0;
+        for (CommandQueue* input : inputs) {
+            size_t taken = 0;
+            while (taken < maxBatchPerInput) {
+                Command* cmd = input->front();
+                if (!cmd) {
+                    break;
+                }
+                cmd->sequence = nextSequence++;
+                cmd->timestamp = timestamp;
+                if (tracer && cmd->traceSlot) {
+                    tracer->stamp(cmd->traceSlot, TraceStage::SEQUENCE);
+                }
+                if (journal) {
+                    journal->append(*cmd);
+                }
+                sink(*cmd);
+                input->pop();
+                ++taken;
+            }
+            total += taken;
+        }
+        return total;
+    }
+
+    uint64_t getNextSequence() const { return nextSequence; }
+};
+
+} // namespace HFT
@@ -0,0 +1,1028 @@
+#pragma once
+
+// Position-independent limit order book held entirely in a named shared
+// memory region: a POSIX shm name such as "/hft_book", or a file path on a
+// hugetlbfs / tmpfs mount. Header, order pool, price levels and the order
+// ID index are plain arrays linked by 32-bit slot indices, so the region
+// is valid at any mapping address and outlives the process. A restarted
+// engine (upgrade or crash, host still up) re-attaches, validates the
+// header, checks every level and recomputes the state hash, then resumes
+// matching without loading a snapshot or replaying the journal.
+//
+//   SharedBookHeader | SharedOrder[maxOrders + 1] | SharedLevel[priceLevels]
+//                    | SharedIndexEntry[indexCapacity] | uint32_t[maxOrders]
+//
+// Prices must lie in [basePrice, basePrice + priceLevels). Bids and asks
+// share the level array: a book that never rests crossed holds any price
+// on one side only. Plain limit GTC orders; trades go to a process-local
+// vector as in OrderBook, and matching, IDs and the state hash agree with
+// OrderBook for the same command stream. Each mutation runs inside an
+// odd/even epoch. SharedBookReader uses it as a seqlock to copy depth out
+// of a read-only mapping in other processes. Linux only.
+//
+// An attach that finds the epoch odd rolls the interrupted update back.
+// Levels, index, free list, best prices, counts and the hash are all
+// derived from the live slots of the order pool, so an update only has to
+// record how to restore those slots: the header undo record keeps the
+// sequence and pool counters and the one slot image the update overwrites,
+// and the trailing kill log lists the slots it retired. Attach replays that
+// record, rebuilds everything else from the pool and resumes at the book as
+// it stood before the update. Records are written ahead of the stores they
+// cover; a SIGKILL stops the writer at an instruction boundary, so only
+// compiler ordering has to be enforced.
+//
+// One writer at a time: create and attach hold flock(LOCK_EX) on the region
+// for as long as it is mapped, and a second writer gets LOCKED (the kernel
+// drops the lock when a writer dies). create never truncates an existing
+// object in place; it unlinks the name and creates a new one, so processes
+// still mapping the old book keep a valid (if stale) region.
+
+#include "Order.hpp"
+#include "OrderId.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <new>
+#include <string>
+#include <vector>
+
+#ifdef __linux__
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace HFT {
+
+struct SharedOrder {
+    uint64_t orderId;
+    uint64_t timestamp;
+    uint32_t price;
+    uint32_t quantity;
+    uint32_t filledQuantity;
+    uint32_t prev;           // Slot ahead in the level's FIFO; 0 = none
+    uint32_t next;           // Slot behind, or the next free slot
+    OrderSide side;
+    uint8_t live;            // Resting; 0 once cancelled, filled or never used
+    uint8_t reserved[2];
+
+    uint32_t getRemainingQuantity() const { return quantity - filledQuantity; }
+};
+
+struct SharedLevel {
+    uint32_t head;
+    uint32_t tail;
+    uint32_t totalQuantity;
+    uint32_t orderCount;
+};
+
+struct SharedIndexEntry {
+    uint64_t orderId;        // 0 = empty bucket
+    uint32_t slot;
+    uint32_t reserved;
+};
+
+// Fixed at create time and covered by the header checksum
+struct SharedBookLayout {
+    uint32_t maxOrders;
+    uint32_t priceLevels;
+    uint32_t basePrice;
+    uint32_t indexCapacity;
+    uint32_t shardId;
+    uint32_t bookId;
+    uint64_t ordersOffset;
+    uint64_t levelsOffset;
+    uint64_t indexOffset;
+    uint64_t killLogOffset;
+    uint64_t regionSize;
+};
+
+struct SharedBookHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t headerSize;
+    SharedBookLayout layout;
+    uint64_t layoutChecksum;
+
+    // Live state, written by the one engine process
+    alignas(64) std::atomic<uint64_t> epoch;   // Odd while an update is in progress
+    uint64_t nextSequence;
+    uint64_t stateHash;
+    uint32_t bestBid;        // 0 = no bids
+    uint32_t bestAsk;        // 0 = no asks
+    uint32_t orderCount;
+    uint32_t bidLevels;      // Non-empty levels per side
+    uint32_t askLevels;
+    uint32_t freeHead;       // Free slots, linked through SharedOrder::next
+    uint32_t poolUsed;       // Slots handed out before the free list
+
+    // Undo record of the update in progress; meaningful while epoch is odd
+    uint64_t undoNextSequence;
+    uint32_t undoPoolUsed;
+    uint32_t undoKillCount;  // Entries in the kill log
+    uint32_t undoSlot;       // Slot undoImage restores; 0 = none
+    SharedOrder undoImage;
+};
+
+static_assert(sizeof(SharedOrder) == 40, "SharedOrder layout");
+static_assert(sizeof(SharedLevel) == 16, "SharedLevel layout");
+static_assert(sizeof(SharedIndexEntry) == 16, "SharedIndexEntry layout");
+static_assert(std::atomic<uint64_t>::is_always_lock_free, "Epoch counter must be address-free");
+
+namespace SharedBookFormat {
+constexpr char MAGIC[8] = {'H', 'F', 'T', 'S', 'B', 'O', 'K', '1'};
+constexpr uint32_t VERSION = 2;   // 2: undo record and kill log
+constexpr size_t REGION_ALIGN = 2u << 20;   // Whole huge pages for hugetlbfs
+
+inline uint64_t checksum(const void* data, size_t length) {
+    const auto* p = static_cast<const uint8_t*>(data);
+    uint64_t h = 0xCBF29CE484222325ull;   // FNV-1a
+    for (size_t i = 0; i < length; ++i) {
+        h = (h ^ p[i]) * 0x100000001B3ull;
+    }
+    return h;
+}
+
+// "/name" is a POSIX shm object; anything with a further '/' is a file path
+inline bool isShmName(const std::string& name) {
+    return name.size() > 1 && name[0] == '/' && name.find('/', 1) == std::string::npos;
+}
+
+// Header describes a complete region of this version within `mappedSize`
+inline bool validHeader(const SharedBookHeader* header, size_t mappedSize) {
+    if (mappedSize < sizeof(SharedBookHeader)) {
+        return false;
+    }
+    const SharedBookLayout& layout = header->layout;
+    return std::memcmp(header->magic, MAGIC, sizeof(header->magic)) == 0 && header->version == VERSION &&
+           header->headerSize == sizeof(SharedBookHeader) &&
+           header->layoutChecksum == checksum(&layout, sizeof(layout)) && layout.regionSize <= mappedSize &&
+           layout.indexCapacity != 0 && (layout.indexCapacity & (layout.indexCapacity - 1)) == 0 &&
+           layout.indexOffset + size_t(layout.indexCapacity) * sizeof(SharedIndexEntry) <= layout.killLogOffset &&
+           layout.killLogOffset + size_t(layout.maxOrders) * sizeof(uint32_t) <= layout.regionSize;
+}
+} // namespace SharedBookFormat
+
+struct SharedBookConfig {
+    uint32_t maxOrders = 1u << 20;
+    uint32_t basePrice = 0;
+    uint32_t priceLevels = 1u << 16;
+    uint32_t shardId = 0;
+    uint32_t bookId = 0;
+};
+
+enum class SharedBookStatus : uint8_t {
+    OK = 0,
+    NOT_FOUND = 1,           // No such region
+    BAD_HEADER = 2,          // Wrong magic / version / layout checksum / size
+    TORN = 3,                // Writer died mid-update and its undo record is unusable
+    CORRUPT = 4,             // Levels, index, free list or state hash do not agree
+    LOCKED = 5,              // Another writer has the region
+    SYSTEM_ERROR = 6         // Could not create, size or map the region
+};
+
+class SharedBook {
+private:
+    char* base = nullptr;
+    size_t mappedSize = 0;
+    int lockFd = -1;         // Holds the writer lock while mapped
+    SharedBookHeader* header = nullptr;
+    SharedOrder* orders = nullptr;
+    SharedLevel* levels = nullptr;
+    SharedIndexEntry* index = nullptr;
+    uint32_t* killLog = nullptr;
+    uint32_t indexMask = 0;
+    uint64_t idPrefix = 0;
+    bool rolledBack = false;
+    std::vector<Trade> trades;
+
+public:
+    SharedBook() = default;
+    SharedBook(const SharedBook&) = delete;
+    SharedBook& operator=(const SharedBook&) = delete;
+    ~SharedBook() { close(); }
+
+    // Create the region with an empty book, replacing any region of that
+    // name no writer holds. BAD_HEADER for an unusable config.
+    SharedBookStatus create(const std::string& name, const SharedBookConfig& config) {
+        if (config.maxOrders == 0 || config.priceLevels == 0) {
+            return SharedBookStatus::BAD_HEADER;
+        }
+        SharedBookLayout layout{};
+        layout.maxOrders = config.maxOrders;
+        layout.priceLevels = config.priceLevels;
+        layout.basePrice = config.basePrice;
+        layout.indexCapacity = 1;
+        while (layout.indexCapacity < 2 * config.maxOrders) {
+            layout.indexCapacity <<= 1;
+        }
+        layout.shardId = config.shardId;
+        layout.bookId = config.bookId;
+        layout.ordersOffset = alignUp(sizeof(SharedBookHeader), 64);
+        layout.levelsOffset = alignUp(layout.ordersOffset + (size_t(layout.maxOrders) + 1) * sizeof(SharedOrder), 64);
+        layout.indexOffset = alignUp(layout.levelsOffset + size_t(layout.priceLevels) * sizeof(SharedLevel), 64);
+        layout.killLogOffset = alignUp(layout.indexOffset + size_t(layout.indexCapacity) * sizeof(SharedIndexEntry), 64);
+        layout.regionSize = alignUp(layout.killLogOffset + size_t(layout.maxOrders) * sizeof(uint32_t),
+                                    SharedBookFormat::REGION_ALIGN);
+
+        // A fresh object is zero-filled: empty levels, index and pool
+        SharedBookStatus status = mapRegion(name, layout.regionSize, true);
+        if (status != SharedBookStatus::OK) {
+            return status;
+        }
+        header = new (base) SharedBookHeader();
+        header->version = SharedBookFormat::VERSION;
+        header->headerSize = sizeof(SharedBookHeader);
+        header->layout = layout;
+        header->layoutChecksum = SharedBookFormat::checksum(&layout, sizeof(layout));
+        header->epoch.store(0, std::memory_order_relaxed);
+        header->nextSequence = 1;
+        bindLayout();
+
+        // Magic last: an interrupted create never looks attachable
+        std::atomic_thread_fence(std::memory_order_release);
+        std::memcpy(header->magic, SharedBookFormat::MAGIC, sizeof(header->magic));
+        return SharedBookStatus::OK;
+    }
+
+    // Map an existing region, roll back an update the last writer did not
+    // finish, and check it end to end before trading on it
+    SharedBookStatus attach(const std::string& name) {
+        SharedBookStatus status = mapRegion(name, 0, false);
+        if (status != SharedBookStatus::OK) {
+            return status;
+        }
+        header = reinterpret_cast<SharedBookHeader*>(base);
+        if (!SharedBookFormat::validHeader(header, mappedSize)) {
+            close();
+            return SharedBookStatus::BAD_HEADER;
+        }
+        bindLayout();
+        if (header->epoch.load(std::memory_order_acquire) & 1) {
+            if (!rollBack()) {
+                close();
+                return SharedBookStatus::TORN;
+            }
+            rolledBack = true;
+        }
+        if (!verify()) {
+            close();
+            return SharedBookStatus::CORRUPT;
+        }
+        return SharedBookStatus::OK;
+    }
+
+    // Unmap and release the writer lock; the region and the book in it stay
+    // for the next attach
+    void close() {
+#ifdef __linux__
+        if (base) {
+            ::munmap(base, mappedSize);
+        }
+        if (lockFd >= 0) {
+            ::close(lockFd);   // Drops the flock
+        }
+#endif
+        lockFd = -1;
+        base = nullptr;
+        mappedSize = 0;
+        header = nullptr;
+        orders = nullptr;
+        levels = nullptr;
+        index = nullptr;
+        killLog = nullptr;
+    }
+
+    static void unlink(const std::string& name) {
+#ifdef __linux__
+        if (SharedBookFormat::isShmName(name)) {
+            ::shm_unlink(name.c_str());
+        } else {
+            ::unlink(name.c_str());
+        }
+#else
+        (void)name;
+#endif
+    }
+
+    bool isOpen() const { return header != nullptr; }
+
+    // The last attach found an interrupted update and rolled it back
+    bool wasRolledBack() const { return rolledBack; }
+
+    // Add a limit GTC order; returns its ID, or 0 if the price is outside
+    // the band or the pool is full
+    uint64_t addOrder(uint32_t price, uint32_t quantity, OrderSide side, uint64_t timestamp) {
+        const SharedBookLayout& layout = header->layout;
+        if (price == 0 || price < layout.basePrice || price - layout.basePrice >= layout.priceLevels ||
+            (header->freeHead == 0 && header->poolUsed == layout.maxOrders)) {
+            return 0;
+        }
+
+        beginUpdate();
+        uint64_t orderId = idPrefix | (header->nextSequence++ & OrderId::SEQUENCE_MASK);
+        uint32_t remaining = side == OrderSide::BUY ? matchBuy(orderId, price, quantity, timestamp)
+                                                    : matchSell(orderId, price, quantity, timestamp);
+        if (remaining > 0) {
+            uint32_t slot = allocateSlot();
+            saveSlot(slot);
+            SharedOrder& order = orders[slot];
+            order.orderId = orderId;
+            order.timestamp = timestamp;
+            order.price = price;
+            order.quantity = quantity;
+            order.filledQuantity = quantity - remaining;
+            order.side = side;
+            order.live = 1;
+            append(slot);
+            indexInsert(orderId, slot);
+            ++header->orderCount;
+            header->stateHash ^= hashOf(order);
+        }
+        endUpdate();
+        return orderId;
+    }
+
+    bool cancelOrder(uint64_t orderId) {
+        uint32_t slot = indexFind(orderId);
+        if (slot == 0) {
+            return false;
+        }
+        beginUpdate();
+        logKill(slot);
+        header->stateHash ^= hashOf(orders[slot]);
+        unlink(slot);
+        indexErase(orderId);
+        freeSlot(slot);
+        --header->orderCount;
+        endUpdate();
+        return true;
+    }
+
+    // Change the order quantity in place, keeping priority (as OrderBook);
+    // false if it would not exceed what has already filled
+    bool modifyOrder(uint64_t orderId, uint32_t newQuantity) {
+        uint32_t slot = indexFind(orderId);
+        if (slot == 0) {
+            return false;
+        }
+        SharedOrder& order = orders[slot];
+        if (newQuantity <= order.filledQuantity) {
+            return false;
+        }
+        beginUpdate();
+        saveSlot(slot);
+        header->stateHash ^= hashOf(order);
+        levelAt(order.price).totalQuantity += newQuantity - order.quantity;
+        order.quantity = newQuantity;
+        header->stateHash ^= hashOf(order);
+        endUpdate();
+        return true;
+    }
+
+    uint32_t getBestBid() const { return header->bestBid; }
+    uint32_t getBestAsk() const { return header->bestAsk; }
+    uint64_t getStateHash() const { return header->stateHash; }
+    uint32_t getOrderCount() const { return header->orderCount; }
+    uint64_t getNextOrderSequence() const { return header->nextSequence; }
+    size_t getRegionSize() const { return mappedSize; }
+
+    const std::vector<Trade>& getTrades() const { return trades; }
+    void clearTrades() { trades.clear(); }
+
+private:
+    static size_t alignUp(size_t value, size_t alignment) {
+        return (value + alignment - 1) / alignment * alignment;
+    }
+
+#ifdef __linux__
+    static int openName(const std::string& name, int flags) {
+        return SharedBookFormat::isShmName(name) ? ::shm_open(name.c_str(), flags, 0644)
+                                                 : ::open(name.c_str(), flags, 0644);
+    }
+
+    // `fd` is still the object linked under `name` (not unlinked and
+    // replaced while we waited for it)
+    static bool stillLinked(int fd, const std::string& name) {
+        int current = openName(name, O_RDONLY);
+        if (current < 0) {
+            return false;
+        }
+        struct stat mine, linked;
+        bool same = ::fstat(fd, &mine) == 0 && ::fstat(current, &linked) == 0 && mine.st_dev == linked.st_dev &&
+                    mine.st_ino == linked.st_ino;
+        ::close(current);
+        return same;
+    }
+#endif
+
+    // Create a new object of `bytes`, or map the existing one, holding the
+    // writer lock on it either way
+    SharedBookStatus mapRegion(const std::string& name, size_t bytes, bool createNew) {
+        close();
+#ifdef __linux__
+        int fd = -1;
+        if (createNew) {
+            // Refuse to replace a region a live writer holds; otherwise
+            // unlink it while locked so nobody attaches it in between
+            int existing = openName(name, O_RDWR);
+            if (existing >= 0) {
+                if (::flock(existing, LOCK_EX | LOCK_NB) != 0) {
+                    ::close(existing);
+                    return SharedBookStatus::LOCKED;
+                }
+                unlink(name);
+                ::close(existing);
+            }
+            fd = openName(name, O_CREAT | O_EXCL | O_RDWR);
+            if (fd < 0) {
+                return errno == EEXIST ? SharedBookStatus::LOCKED : SharedBookStatus::SYSTEM_ERROR;
+            }
+        } else {
+            fd = openName(name, O_RDWR);
+            if (fd < 0) {
+                return SharedBookStatus::NOT_FOUND;
+            }
+        }
+        if (::flock(fd, LOCK_EX | LOCK_NB) != 0) {
+            ::close(fd);
+            return SharedBookStatus::LOCKED;
+        }
+        if (!createNew && !stillLinked(fd, name)) {
+            ::close(fd);
+            return SharedBookStatus::NOT_FOUND;
+        }
+
+        bool ok = true;
+        if (createNew) {
+            ok = ::ftruncate(fd, static_cast<off_t>(bytes)) == 0;
+        } else {
+            struct stat st;
+            ok = ::fstat(fd, &st) == 0 && st.st_size > 0;
+            bytes = ok ? static_cast<size_t>(st.st_size) : 0;
+        }
+        void* p = ok ? ::mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, 0) : MAP_FAILED;
+        if (p == MAP_FAILED) {
+            ::close(fd);
+            if (createNew) {
+                unlink(name);
+            }
+            return createNew ? SharedBookStatus::SYSTEM_ERROR : SharedBookStatus::BAD_HEADER;
+        }
+        base = static_cast<char*>(p);
+        mappedSize = bytes;
+        lockFd = fd;
+        return SharedBookStatus::OK;
+#else
+        (void)name;
+        (void)bytes;
+        (void)createNew;
+        return SharedBookStatus::SYSTEM_ERROR;
+#endif
+    }
+
+    void bindLayout() {
+        const SharedBookLayout& layout = header->layout;
+        orders = reinterpret_cast<SharedOrder*>(base + layout.ordersOffset);
+        levels = reinterpret_cast<SharedLevel*>(base + layout.levelsOffset);
+        index = reinterpret_cast<SharedIndexEntry*>(base + layout.indexOffset);
+        killLog = reinterpret_cast<uint32_t*>(base + layout.killLogOffset);
+        indexMask = layout.indexCapacity - 1;
+        idPrefix = OrderId::encode(layout.shardId, layout.bookId, 0);
+        rolledBack = false;
+        trades.clear();
+    }
+
+    // Undo record first, then the odd epoch that makes attach use it
+    void beginUpdate() {
+        header->undoNextSequence = header->nextSequence;
+        header->undoPoolUsed = header->poolUsed;
+        header->undoKillCount = 0;
+        header->undoSlot = 0;
+        std::atomic_signal_fence(std::memory_order_seq_cst);
+        header->epoch.store(header->epoch.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+    }
+
+    // Keep `slot` as it was before the update overwrites it (at most one
+    // slot per update: a partly filled resting order, a modified order or
+    // the slot a new order rests in)
+    void saveSlot(uint32_t slot) {
+        header->undoImage = orders[slot];
+        std::atomic_signal_fence(std::memory_order_seq_cst);
+        header->undoSlot = slot;
+        std::atomic_signal_fence(std::memory_order_seq_cst);
+    }
+
+    // `slot` stops resting in this update; rolling back revives it
+    void logKill(uint32_t slot) {
+        killLog[header->undoKillCount] = slot;
+        std::atomic_signal_fence(std::memory_order_seq_cst);
+        ++header->undoKillCount;
+        std::atomic_signal_fence(std::memory_order_seq_cst);
+    }
+
+    void endUpdate() {
+        header->epoch.store(header->epoch.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+    static uint64_t hashOf(const SharedOrder& order) {
+        return restingOrderHash(order.orderId, order.price, order.side, order.getRemainingQuantity());
+    }
+
+    SharedLevel& levelAt(uint32_t price) { return levels[price - header->layout.basePrice]; }
+
+    // Order pool
+
+    uint32_t allocateSlot() {
+        uint32_t slot = header->freeHead;
+        if (slot != 0) {
+            header->freeHead = orders[slot].next;
+        } else {
+            slot = ++header->poolUsed;
+        }
+        return slot;
+    }
+
+    void freeSlot(uint32_t slot) {
+        orders[slot].live = 0;
+        orders[slot].next = header->freeHead;
+        header->freeHead = slot;
+    }
+
+    // Levels
+
+    void append(uint32_t slot) {
+        SharedOrder& order = orders[slot];
+        SharedLevel& level = levelAt(order.price);
+        order.prev = level.tail;
+        order.next = 0;
+        if (level.tail != 0) {
+            orders[level.tail].next = slot;
+        } else {
+            level.head = slot;
+        }
+        level.tail = slot;
+        level.totalQuantity += order.getRemainingQuantity();
+        if (level.orderCount++ == 0) {
+            if (order.side == OrderSide::BUY) {
+                ++header->bidLevels;
+                if (order.price > header->bestBid) header->bestBid = order.price;
+            } else {
+                ++header->askLevels;
+                if (header->bestAsk == 0 || order.price < header->bestAsk) header->bestAsk = order.price;
+            }
+        }
+    }
+
+    void unlink(uint32_t slot) {
+        SharedOrder& order = orders[slot];
+        SharedLevel& level = levelAt(order.price);
+        if (order.prev != 0) orders[order.prev].next = order.next; else level.head = order.next;
+        if (order.next != 0) orders[order.next].prev = order.prev; else level.tail = order.prev;
+        level.totalQuantity -= order.getRemainingQuantity();
+        if (--level.orderCount == 0) {
+            levelEmptied(order.side, order.price);
+        }
+    }
+
+    // Walk outward from an emptied best level to the next non-empty one
+    void levelEmptied(OrderSide side, uint32_t price) {
+        const uint32_t first = header->layout.basePrice;
+        if (side == OrderSide::BUY) {
+            if (--header->bidLevels == 0) {
+                header->bestBid = 0;
+            } else if (price == header->bestBid) {
+                uint32_t p = price - 1;
+                while (p > first && levelAt(p).orderCount == 0) --p;
+                header->bestBid = p;
+            }
+        } else {
+            if (--header->askLevels == 0) {
+                header->bestAsk = 0;
+            } else if (price == header->bestAsk) {
+                uint32_t p = price + 1;
+                while (levelAt(p).orderCount == 0) ++p;
+                header->bestAsk = p;
+            }
+        }
+    }
+
+    // Matching: fill against the opposite best levels in price-time
+    // priority; returns the unfilled quantity
+
+    uint32_t matchBuy(uint64_t orderId, uint32_t price, uint32_t quantity, uint64_t timestamp) {
+        while (quantity > 0 && header->bestAsk != 0 && price >= header->bestAsk) {
+            quantity = matchLevel(orderId, OrderSide::BUY, header->bestAsk, quantity, timestamp);
+        }
+        return quantity;
+    }
+
+    uint32_t matchSell(uint64_t orderId, uint32_t price, uint32_t quantity, uint64_t timestamp) {
+        while (quantity > 0 && header->bestBid != 0 && price <= header->bestBid) {
+            quantity = matchLevel(orderId, OrderSide::SELL, header->bestBid, quantity, timestamp);
+        }
+        return quantity;
+    }
+
+    uint32_t matchLevel(uint64_t orderId, OrderSide side, uint32_t levelPrice, uint32_t quantity, uint64_t timestamp) {
+        SharedLevel& level = levelAt(levelPrice);
+        while (quantity > 0 && level.head != 0) {
+            uint32_t slot = level.head;
+            SharedOrder& resting = orders[slot];
+            uint32_t available = resting.getRemainingQuantity();
+            uint32_t tradeQty = quantity < available ? quantity : available;
+
+            header->stateHash ^= hashOf(resting);
+            quantity -= tradeQty;
+            if (side == OrderSide::BUY) {
+                trades.emplace_back(orderId, resting.orderId, levelPrice, tradeQty, timestamp);
+            } else {
+                trades.emplace_back(resting.orderId, orderId, levelPrice, tradeQty, timestamp);
+            }
+
+            if (tradeQty == available) {
+                logKill(slot);
+                unlink(slot);   // May move the best price on
+                indexErase(resting.orderId);
+                freeSlot(slot);
+                --header->orderCount;
+            } else {
+                saveSlot(slot);
+                resting.filledQuantity += tradeQty;
+                level.totalQuantity -= tradeQty;
+                header->stateHash ^= hashOf(resting);
+            }
+        }
+        return quantity;
+    }
+
+    // Order ID index: linear probing with backward-shift deletion
+
+    uint32_t bucketOf(uint64_t orderId) const {
+        return static_cast<uint32_t>((orderId * 0x9E3779B97F4A7C15ull) >> 32) & indexMask;
+    }
+
+    uint32_t indexFind(uint64_t orderId) const {
+        if (orderId == 0) {
+            return 0;
+        }
+        for (uint32_t i = bucketOf(orderId);; i = (i + 1) & indexMask) {
+            if (index[i].orderId == orderId) return index[i].slot;
+            if (index[i].orderId == 0) return 0;
+        }
+    }
+
+    void indexInsert(uint64_t orderId, uint32_t slot) {
+        uint32_t i = bucketOf(orderId);
+        while (index[i].orderId != 0) {
+            i = (i + 1) & indexMask;
+        }
+        index[i].orderId = orderId;
+        index[i].slot = slot;
+    }
+
+    void indexErase(uint64_t orderId) {
+        uint32_t i = bucketOf(orderId);
+        while (index[i].orderId != orderId) {
+            i = (i + 1) & indexMask;
+        }
+        // Pull later entries of the probe run back over the hole
+        for (uint32_t j = (i + 1) & indexMask; index[j].orderId != 0; j = (j + 1) & indexMask) {
+            uint32_t home = bucketOf(index[j].orderId);
+            bool movable = i <= j ? (home <= i || home > j) : (home <= i && home > j);
+            if (movable) {
+                index[i] = index[j];
+                i = j;
+            }
+        }
+        index[i].orderId = 0;
+        index[i].slot = 0;
+    }
+
+    // Undo the update a dead writer left half done: restore the saved slot
+    // image, revive the slots it retired, put the counters back, then
+    // rebuild the derived state. False if the record is out of bounds.
+    bool rollBack() {
+        const SharedBookLayout& layout = header->layout;
+        if (header->undoPoolUsed > layout.maxOrders || header->undoSlot > layout.maxOrders ||
+            header->undoKillCount > layout.maxOrders) {
+            return false;
+        }
+        // The image first: a slot retired and then reused by the same update
+        // keeps its contents and is revived by the kill log below
+        if (header->undoSlot != 0) {
+            orders[header->undoSlot] = header->undoImage;
+        }
+        for (uint32_t i = 0; i < header->undoKillCount; ++i) {
+            if (killLog[i] == 0 || killLog[i] > header->undoPoolUsed) {
+                return false;
+            }
+            orders[killLog[i]].live = 1;
+        }
+        header->nextSequence = header->undoNextSequence;
+        header->poolUsed = header->undoPoolUsed;
+        if (!rebuild()) {
+            return false;
+        }
+        header->epoch.store(header->epoch.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Levels, index, free list, best prices, counts and the hash from the
+    // live slots. Each level queues its orders by ID, which is arrival
+    // order (a modify keeps its place).
+    bool rebuild() {
+        const SharedBookLayout& layout = header->layout;
+        std::memset(static_cast<void*>(levels), 0, size_t(layout.priceLevels) * sizeof(SharedLevel));
+        std::memset(static_cast<void*>(index), 0, size_t(layout.indexCapacity) * sizeof(SharedIndexEntry));
+        header->stateHash = 0;
+        header->bestBid = 0;
+        header->bestAsk = 0;
+        header->orderCount = 0;
+        header->bidLevels = 0;
+        header->askLevels = 0;
+        header->freeHead = 0;
+
+        std::vector<uint32_t> resting;
+        for (uint32_t slot = header->poolUsed; slot != 0; --slot) {
+            const SharedOrder& order = orders[slot];
+            if (!order.live) {
+                freeSlot(slot);
+                continue;
+            }
+            if (order.orderId == 0 || order.price < layout.basePrice ||
+                order.price - layout.basePrice >= layout.priceLevels || order.filledQuantity >= order.quantity ||
+                (order.side != OrderSide::BUY && order.side != OrderSide::SELL)) {
+                return false;
+            }
+            resting.push_back(slot);
+        }
+        std::sort(resting.begin(), resting.end(),
+                  [this](uint32_t a, uint32_t b) { return orders[a].orderId < orders[b].orderId; });
+        for (uint32_t slot : resting) {
+            append(slot);
+            indexInsert(orders[slot].orderId, slot);
+            ++header->orderCount;
+            header->stateHash ^= hashOf(orders[slot]);
+        }
+        return true;
+    }
+
+    // Full consistency pass for attach: level lists, free list, index, best
+    // prices, counts and the state hash must all agree. Every slot is
+    // bounds-checked before it is followed and visited at most once, so a
+    // corrupt region is refused rather than walked out of or looped on.
+    bool verify() const {
+        const SharedBookLayout& layout = header->layout;
+        if (header->poolUsed > layout.maxOrders || header->freeHead > header->poolUsed) {
+            return false;
+        }
+        // An index with no empty bucket would never end a probe
+        uint32_t indexed = 0;
+        for (uint32_t i = 0; i < layout.indexCapacity; ++i) {
+            if (index[i].orderId != 0) {
+                ++indexed;
+            }
+        }
+        if (indexed > layout.maxOrders || indexed == layout.indexCapacity) {
+            return false;
+        }
+
+        std::vector<uint8_t> seen(static_cast<size_t>(header->poolUsed) + 1, 0);
+        uint64_t hash = 0;
+        uint32_t count = 0;
+        uint32_t bidLevels = 0;
+        uint32_t askLevels = 0;
+        uint32_t bestBid = 0;
+        uint32_t bestAsk = 0;
+        for (uint32_t i = 0; i < layout.priceLevels; ++i) {
+            const SharedLevel& level = levels[i];
+            if (level.orderCount == 0) {
+                if (level.head != 0 || level.tail != 0 || level.totalQuantity != 0) return false;
+                continue;
+            }
+            if (level.head == 0 || level.head > header->poolUsed || level.tail == 0 ||
+                level.tail > header->poolUsed) {
+                return false;
+            }
+            uint32_t price = layout.basePrice + i;
+            uint32_t walked = 0;
+            uint32_t quantity = 0;
+            uint32_t prev = 0;
+            OrderSide side = orders[level.head].side;
+            for (uint32_t slot = level.head; slot != 0; slot = orders[slot].next) {
+                if (slot > header->poolUsed || seen[slot] || walked == level.orderCount) return false;
+                seen[slot] = 1;
+                const SharedOrder& order = orders[slot];
+                if (!order.live || order.prev != prev || order.price != price || order.side != side ||
+                    indexFind(order.orderId) != slot) {
+                    return false;
+                }
+                hash ^= hashOf(order);
+                quantity += order.getRemainingQuantity();
+                prev = slot;
+                ++walked;
+            }
+            if (walked != level.orderCount || prev != level.tail || quantity != level.totalQuantity) return false;
+            if (side == OrderSide::BUY) {
+                ++bidLevels;
+                bestBid = price;
+            } else if (askLevels++ == 0) {
+                bestAsk = price;
+            }
+            count += walked;
+        }
+
+        // Every slot below poolUsed is either resting or on the free list
+        uint32_t freeSlots = 0;
+        for (uint32_t slot = header->freeHead; slot != 0; slot = orders[slot].next) {
+            if (slot > header->poolUsed || seen[slot] || orders[slot].live) return false;
+            seen[slot] = 1;
+            ++freeSlots;
+        }
+        if (count + freeSlots != header->poolUsed) {
+            return false;
+        }
+        return indexed == count && hash == header->stateHash && count == header->orderCount && bidLevels == header->bidLevels &&
+               askLevels == header->askLevels && bestBid == header->bestBid && bestAsk == header->bestAsk &&
+               (bestBid == 0 || bestAsk == 0 || bestBid < bestAsk);
+    }
+};
+
+constexpr uint32_t SHARED_DEPTH_MAX = 32;
+
+struct SharedDepthLevel {
+    uint32_t price;
+    uint32_t quantity;
+    uint32_t orderCount;
+};
+
+// Consistent copy of the best levels of both sides, best first
+struct SharedBookDepth {
+    uint64_t epoch;          // Even epoch the copy was taken at
+    uint32_t bidLevels;
+    uint32_t askLevels;
+    SharedDepthLevel bids[SHARED_DEPTH_MAX];
+    SharedDepthLevel asks[SHARED_DEPTH_MAX];
+};
+
+// Reader side for risk / surveillance processes: maps a live book
+// read-only and copies depth and level queues out under the epoch. A copy
+// that overlapped a write is thrown away and retried, so the writer never
+// waits for readers and readers never take a lock. Every slot and price
+// read inside the window is bounds-checked, so a torn read is discarded
+// rather than followed out of the region.
+class SharedBookReader {
+private:
+    const char* base = nullptr;
+    size_t mappedSize = 0;
+    const SharedBookHeader* header = nullptr;
+    const SharedOrder* orders = nullptr;
+    const SharedLevel* levels = nullptr;
+    uint32_t basePrice = 0;
+    uint32_t priceLevels = 0;
+    uint32_t maxOrders = 0;
+
+public:
+    SharedBookReader() = default;
+    SharedBookReader(const SharedBookReader&) = delete;
+    SharedBookReader& operator=(const SharedBookReader&) = delete;
+    ~SharedBookReader() { close(); }
+
+    bool open(const std::string& name) {
+        close();
+#ifdef __linux__
+        int fd = SharedBookFormat::isShmName(name) ? ::shm_open(name.c_str(), O_RDONLY, 0)
+                                                   : ::open(name.c_str(), O_RDONLY);
+        if (fd < 0) {
+            return false;
+        }
+        struct stat st;
+        void* p = MAP_FAILED;
+        if (::fstat(fd, &st) == 0 && static_cast<size_t>(st.st_size) >= sizeof(SharedBookHeader)) {
+            p = ::mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_SHARED, fd, 0);
+        }
+        ::close(fd);
+        if (p == MAP_FAILED) {
+            return false;
+        }
+        base = static_cast<const char*>(p);
+        mappedSize = static_cast<size_t>(st.st_size);
+
+        header = reinterpret_cast<const SharedBookHeader*>(base);
+        if (!SharedBookFormat::validHeader(header, mappedSize)) {
+            close();
+            return false;
+        }
+        std::atomic_thread_fence(std::memory_order_acquire);
+        const SharedBookLayout& layout = header->layout;
+        orders = reinterpret_cast<const SharedOrder*>(base + layout.ordersOffset);
+        levels = reinterpret_cast<const SharedLevel*>(base + layout.levelsOffset);
+        basePrice = layout.basePrice;
+        priceLevels = layout.priceLevels;
+        maxOrders = layout.maxOrders;
+        return true;
+#else
+        (void)name;
+        return false;
+#endif
+    }
+
+    void close() {
+#ifdef __linux__
+        if (base) {
+            ::munmap(const_cast<char*>(base), mappedSize);
+        }
+#endif
+        base = nullptr;
+        mappedSize = 0;
+        header = nullptr;
+        orders = nullptr;
+        levels = nullptr;
+    }
+
+    bool isOpen() const { return header != nullptr; }
+
+    // Number of completed updates; cheap change detection
+    uint64_t getUpdateCount() const { return header->epoch.load(std::memory_order_acquire) / 2; }
+
+    // Single attempt at the best `depth` levels per side. Cost grows with
+    // the price span walked, so it is cheapest on a dense book.
+    bool tryReadDepth(uint32_t depth, SharedBookDepth& out) const {
+        uint64_t before = header->epoch.load(std::memory_order_acquire);
+        if (before & 1) {
+            return false;
+        }
+        depth = depth < SHARED_DEPTH_MAX ? depth : SHARED_DEPTH_MAX;
+        out.bidLevels = 0;
+        for (uint32_t p = header->bestBid; p != 0 && inBand(p) && out.bidLevels < depth; --p) {
+            const SharedLevel& level = levels[p - basePrice];
+            if (level.orderCount != 0) {
+                out.bids[out.bidLevels++] = {p, level.totalQuantity, level.orderCount};
+            }
+        }
+        out.askLevels = 0;
+        for (uint32_t p = header->bestAsk; p != 0 && inBand(p) && out.askLevels < depth; ++p) {
+            const SharedLevel& level = levels[p - basePrice];
+            if (level.orderCount != 0) {
+                out.asks[out.askLevels++] = {p, level.totalQuantity, level.orderCount};
+            }
+        }
+        std::atomic_thread_fence(std::memory_order_acquire);
+        out.epoch = before;
+        return header->epoch.load(std::memory_order_relaxed) == before;
+    }
+
+    // Single attempt at the first `capacity` orders queued at `price`, in
+    // time priority; `count` receives how many were copied
+    bool tryReadLevel(uint32_t price, SharedOrder* out, uint32_t capacity, uint32_t& count) const {
+        uint64_t before = header->epoch.load(std::memory_order_acquire);
+        if (before & 1) {
+            return false;
+        }
+        count = 0;
+        if (inBand(price)) {
+            for (uint32_t slot = levels[price - basePrice].head; slot != 0 && count < capacity;
+                 slot = out[count - 1].next) {
+                if (slot > maxOrders) {
+                    return false;   // Torn link; the epoch check would fail too
+                }
+                out[count++] = orders[slot];
+            }
+        }
+        std::atomic_thread_fence(std::memory_order_acquire);
+        return header->epoch.load(std::memory_order_relaxed) == before;
+    }
+
+    // Retry until a consistent copy is taken; false only if the book stays
+    // busy for `maxAttempts` (e.g. the writer died mid-update)
+    bool readDepth(uint32_t depth, SharedBookDepth& out, uint32_t maxAttempts = 1u << 20) const {
+        for (uint32_t attempt = 0; attempt < maxAttempts; ++attempt) {
+            if (tryReadDepth(depth, out)) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool readLevel(uint32_t price, SharedOrder* out, uint32_t capacity, uint32_t& count,
+                   uint32_t maxAttempts = 1u << 20) const {
+        for (uint32_t attempt = 0; attempt < maxAttempts; ++attempt) {
+            if (tryReadLevel(price, out, capacity, count)) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+private:
+    bool inBand(uint32_t price) const { return price >= basePrice && price - basePrice < priceLevels; }
+};
+
+} // namespace HFT
@@ -0,0 +1,545 @@
+#pragma once
+
+// Size-class slab pool for a book's node allocations (orders, levels and
+// the list / tree / hash nodes that index them), with optional background
+// growth.
+//
+// Blocks of up to MAX_BLOCK bytes come from SLAB_BYTES slabs, each holding
+// one 16-byte size class. Slabs are aligned to their size, so a block finds
+// its slab with a mask. Allocation and release are a free-list pop / push
+// on the owning (matching) thread.
+//
+// With a SlabGrower attached the grower maps and pre-faults slabs ahead of
+// the matching thread and hands them over through a per-class SPSC ring of
+// spares. A class asks for spares when reserveLike() covers it, once it
+// has less than two slabs free, and each time it takes one. The grower
+// keeps a per-class target queued: twice what the class took since the
+// last poll, doubled again whenever the class ran dry and mapped a slab
+// inline, kept between MIN_SPARES and MAX_SPARES and reset once the
+// class stays under a quarter full. Queued spares stay mapped until the
+// class uses them. Growth can still land on the matching thread when a
+// ramp outruns the target or the grower is starved of CPU (e.g. sharing
+// the matching thread's core); getInlineGrowths() counts it. Without a
+// grower every slab is mapped inline on demand.
+//
+// The grower also watches occupancy: while a class has stayed under a
+// quarter full for `releaseAfterMs`, each release that finds a completely
+// free slab (beyond two slabs of headroom) hands it back and the grower
+// unmaps it. Only whole slabs go back, so a class whose survivors are
+// scattered across slabs keeps them mapped. Capacity pre-faulted by
+// reserveLike() is a floor that is never released.
+//
+// Only node allocations come from the pool. A book's order ID map buckets,
+// handle slot vectors and trade buffer are reserved by warmUp() but grow
+// through operator new on the matching thread once a session outgrows
+// that reservation.
+
+#include "SpscQueue.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <new>
+#include <thread>
+#include <vector>
+
+#ifdef __linux__
+#include <sys/mman.h>
+#endif
+
+namespace HFT {
+
+class SlabGrower;
+
+class SlabPool {
+public:
+    static constexpr size_t SLAB_BYTES = 64 * 1024;
+    static constexpr size_t GRANULE = 16;
+    static constexpr size_t CLASSES = 8;
+    static constexpr size_t MAX_BLOCK = GRANULE * CLASSES;   // Larger requests use operator new
+    static constexpr uint32_t MIN_SPARES = 8;                 // Pre-faulted slabs queued per growing class
+    static constexpr uint32_t MAX_SPARES = 32;
+
+private:
+    struct Slab {
+        Slab* prev;              // Available list, or next on the empty stack
+        Slab* next;
+        Slab* allPrev;           // Every slab the pool owns
+        Slab* allNext;
+        void* freeList;
+        uint32_t freeCount;      // Free-listed plus never-used blocks
+        uint32_t bumped;         // Blocks handed out at least once
+        uint32_t sizeClass;
+    };
+
+    static constexpr size_t HEADER_BYTES = 64;
+    static_assert(sizeof(Slab) <= HEADER_BYTES, "Slab header must fit its reserved space");
+
+    struct alignas(64) SizeClass {
+        Slab* head = nullptr;    // Part-used slabs; allocate from the head
+        Slab* tail = nullptr;
+        Slab* empty = nullptr;   // Completely free slabs, used after the above
+        uint64_t freeBlocks = 0;
+
+        // Shared with the grower
+        SpscQueue<Slab*, MAX_SPARES> spares;   // Grower -> pool, pre-faulted
+        std::atomic<bool> growRequested{false};
+        std::atomic<bool> shrinkRequested{false};
+        std::atomic<uint64_t> used{0};
+        std::atomic<uint64_t> capacity{0};
+        std::atomic<uint64_t> reserved{0};     // reserveLike floor, never released
+        std::atomic<uint64_t> inlineGrowths{0};
+
+        // Grower only
+        uint32_t spareTarget = MIN_SPARES;
+        uint32_t sparesLeft = 0;               // Queued after the last top-up
+        uint64_t inlineSeen = 0;
+        uint64_t lowSinceMs = 0;
+    };
+
+    SizeClass classes[CLASSES];
+    Slab* allSlabs = nullptr;
+    std::atomic<Slab*> retired{nullptr};   // Empty slabs for the grower to unmap
+    SlabGrower* grower = nullptr;
+
+public:
+    SlabPool() = default;
+    SlabPool(const SlabPool&) = delete;
+    SlabPool& operator=(const SlabPool&) = delete;
+    ~SlabPool();
+
+    // Hand growth and release to `slabGrower` (nullptr = grow inline)
+    void setGrower(SlabGrower* slabGrower);
+
+    static constexpr uint32_t blocksPerSlab(size_t sizeClass) {
+        return static_cast<uint32_t>((SLAB_BYTES - HEADER_BYTES) / ((sizeClass + 1) * GRANULE));
+    }
+
+    void* allocate(size_t bytes) {
+        if (bytes == 0 || bytes > MAX_BLOCK) {
+            return ::operator new(bytes);
+        }
+        const size_t c = (bytes - 1) / GRANULE;
+        SizeClass& sizeClass = classes[c];
+        Slab* slab = sizeClass.head ? sizeClass.head : refill(c);
+
+        void* block = slab->freeList;
+        if (block) {
+            slab->freeList = *static_cast<void**>(block);
+        } else {
+            block = reinterpret_cast<char*>(slab) + HEADER_BYTES + size_t(slab->bumped++) * (c + 1) * GRANULE;
+        }
+        if (--slab->freeCount == 0) {
+            unlinkAvailable(sizeClass, slab);
+        }
+        --sizeClass.freeBlocks;
+        sizeClass.used.store(sizeClass.used.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+
+        // Low watermark: ask for spares while two slabs are still left
+        if (grower && sizeClass.freeBlocks < 2 * uint64_t(blocksPerSlab(c)) &&
+            !sizeClass.growRequested.load(std::memory_order_relaxed) && sizeClass.spares.empty()) {
+            sizeClass.growRequested.store(true, std::memory_order_release);
+        }
+        return block;
+    }
+
+    void deallocate(void* block, size_t bytes) {
+        if (bytes == 0 || bytes > MAX_BLOCK) {
+            ::operator delete(block);
+            return;
+        }
+        const size_t c = (bytes - 1) / GRANULE;
+        SizeClass& sizeClass = classes[c];
+        Slab* slab = slabOf(block);
+        *static_cast<void**>(block) = slab->freeList;
+        slab->freeList = block;
+        if (slab->freeCount++ == 0) {
+            linkAvailable(sizeClass, slab);
+        }
+        if (slab->freeCount == blocksPerSlab(c)) {
+            unlinkAvailable(sizeClass, slab);
+            slab->next = sizeClass.empty;
+            sizeClass.empty = slab;
+        }
+        ++sizeClass.freeBlocks;
+        sizeClass.used.store(sizeClass.used.load(std::memory_order_relaxed) - 1, std::memory_order_relaxed);
+
+        // Sustained low occupancy: give back an empty slab, keeping two
+        // slabs of headroom so growth is not requested again at once, and
+        // never dropping under the reserved floor
+        if (sizeClass.empty && sizeClass.shrinkRequested.load(std::memory_order_relaxed) &&
+            sizeClass.freeBlocks >= 3 * uint64_t(blocksPerSlab(c)) &&
+            sizeClass.capacity.load(std::memory_order_relaxed) >=
+                sizeClass.reserved.load(std::memory_order_relaxed) + blocksPerSlab(c)) {
+            retire(sizeClass);
+        }
+    }
+
+    // Blocks in use / mapped across all classes
+    uint64_t getUsedBlocks() const { return sum(&SizeClass::used); }
+    uint64_t getCapacityBlocks() const { return sum(&SizeClass::capacity); }
+
+    // Slabs the matching thread had to map itself (no spare was ready)
+    uint64_t getInlineGrowths() const { return sum(&SizeClass::inlineGrowths); }
+
+    size_t getMappedBytes() const {
+        size_t slabs = 0;
+        for (const SizeClass& sizeClass : classes) {
+            slabs += sizeClass.capacity.load(std::memory_order_relaxed) / blocksPerSlab(&sizeClass - classes);
+        }
+        return slabs * SLAB_BYTES;
+    }
+
+    // Owning thread, before trading: map and pre-fault empty slabs until
+    // every class has at least the capacity `profile` has mapped (e.g. a
+    // shadow pool that has carried the expected load). That capacity stays
+    // mapped for the pool's lifetime, and with a grower attached each class
+    // it covers also gets spares queued for growth past it. Returns the
+    // number of slabs mapped.
+    size_t reserveLike(const SlabPool& profile) {
+        size_t mapped = 0;
+        for (size_t c = 0; c < CLASSES; ++c) {
+            SizeClass& sizeClass = classes[c];
+            const uint64_t target = profile.classes[c].capacity.load(std::memory_order_relaxed);
+            sizeClass.reserved.store(std::max(sizeClass.reserved.load(std::memory_order_relaxed), target),
+                                     std::memory_order_relaxed);
+            while (sizeClass.capacity.load(std::memory_order_relaxed) < target) {
+                Slab* slab = mapSlab();
+                if (!slab) {
+                    throw std::bad_alloc();
+                }
+                prefault(slab);
+                adopt(c, slab);
+                slab->next = sizeClass.empty;
+                sizeClass.empty = slab;
+                ++mapped;
+            }
+            if (grower && target > 0) {
+                sizeClass.growRequested.store(true, std::memory_order_release);
+            }
+        }
+        return mapped;
+    }
+
+    // Grower thread: unmap retired slabs, top up requested spares, and
+    // decide when sustained low occupancy should release a slab
+    void service(uint64_t nowMs, uint64_t releaseAfterMs) {
+        Slab* slab = retired.exchange(nullptr, std::memory_order_acquire);
+        while (slab) {
+            Slab* next = slab->next;
+            unmapSlab(slab);
+            slab = next;
+        }
+
+        for (size_t c = 0; c < CLASSES; ++c) {
+            SizeClass& sizeClass = classes[c];
+
+            // Queue twice what the class took since the last poll, and
+            // double up again whenever it ran dry
+            uint32_t queued = static_cast<uint32_t>(sizeClass.spares.size());
+            uint32_t taken = sizeClass.sparesLeft > queued ? sizeClass.sparesLeft - queued : 0;
+            uint32_t target = std::max(sizeClass.spareTarget, 2 * taken);
+            uint64_t inlineGrowths = sizeClass.inlineGrowths.load(std::memory_order_relaxed);
+            if (inlineGrowths != sizeClass.inlineSeen) {
+                sizeClass.inlineSeen = inlineGrowths;
+                target = std::max(target, 2 * sizeClass.spareTarget);
+            }
+            sizeClass.spareTarget = std::min(MAX_SPARES, target);
+
+            // Clear before topping up so a request raised meanwhile survives
+            if (sizeClass.growRequested.exchange(false, std::memory_order_acquire)) {
+                while (queued < sizeClass.spareTarget) {
+                    Slab* spare = mapSlab();
+                    if (!spare) {
+                        break;
+                    }
+                    prefault(spare);
+                    sizeClass.spares.tryPush(spare);
+                    ++queued;
+                }
+            }
+            sizeClass.sparesLeft = queued;
+
+            uint64_t capacity = sizeClass.capacity.load(std::memory_order_relaxed);
+            uint64_t used = sizeClass.used.load(std::memory_order_relaxed);
+            uint64_t reserved = sizeClass.reserved.load(std::memory_order_relaxed);
+            if (capacity < 2 * uint64_t(blocksPerSlab(c)) || used * 4 >= capacity ||
+                capacity < reserved + blocksPerSlab(c)) {
+                sizeClass.lowSinceMs = 0;
+                sizeClass.shrinkRequested.store(false, std::memory_order_relaxed);
+            } else if (sizeClass.lowSinceMs == 0) {
+                sizeClass.lowSinceMs = nowMs;
+            } else if (nowMs - sizeClass.lowSinceMs >= releaseAfterMs) {
+                sizeClass.shrinkRequested.store(true, std::memory_order_relaxed);
+                sizeClass.spareTarget = MIN_SPARES;   // Growth is over
+            }
+        }
+    }
+
+private:
+    static Slab* slabOf(void* block) {
+        return reinterpret_cast<Slab*>(reinterpret_cast<uintptr_t>(block) & ~uintptr_t(SLAB_BYTES - 1));
+    }
+
+    uint64_t sum(std::atomic<uint64_t> SizeClass::*field) const {
+        uint64_t total = 0;
+        for (const SizeClass& sizeClass : classes) {
+            total += (sizeClass.*field).load(std::memory_order_relaxed);
+        }
+        return total;
+    }
+
+    // No part-used slab left: reuse an empty one, else take one of the
+    // grower's spares (asking it to top up), else map a slab here
+    Slab* refill(size_t c) {
+        SizeClass& sizeClass = classes[c];
+        if (Slab* slab = sizeClass.empty) {
+            sizeClass.empty = slab->next;
+            linkAvailable(sizeClass, slab);
+            return slab;
+        }
+        Slab* slab = nullptr;
+        if (sizeClass.spares.tryPop(slab)) {
+            if (grower) {
+                sizeClass.growRequested.store(true, std::memory_order_release);
+            }
+        } else {
+            sizeClass.inlineGrowths.store(sizeClass.inlineGrowths.load(std::memory_order_relaxed) + 1,
+                                          std::memory_order_relaxed);
+            slab = mapSlab();
+            if (!slab) {
+                throw std::bad_alloc();
+            }
+        }
+        adopt(c, slab);
+        linkAvailable(sizeClass, slab);
+        return slab;
+    }
+
+    // Take ownership of a freshly mapped slab for class `c`, all blocks free
+    void adopt(size_t c, Slab* slab) {
+        SizeClass& sizeClass = classes[c];
+        slab->freeList = nullptr;
+        slab->freeCount = blocksPerSlab(c);
+        slab->bumped = 0;
+        slab->sizeClass = static_cast<uint32_t>(c);
+        slab->allPrev = nullptr;
+        slab->allNext = allSlabs;
+        if (allSlabs) {
+            allSlabs->allPrev = slab;
+        }
+        allSlabs = slab;
+        sizeClass.freeBlocks += blocksPerSlab(c);
+        sizeClass.capacity.store(sizeClass.capacity.load(std::memory_order_relaxed) + blocksPerSlab(c),
+                                 std::memory_order_relaxed);
+    }
+
+    // Slabs that regain space queue behind the ones being filled, so
+    // sparse slabs get a chance to empty out
+    void linkAvailable(SizeClass& sizeClass, Slab* slab) {
+        slab->prev = sizeClass.tail;
+        slab->next = nullptr;
+        if (sizeClass.tail) {
+            sizeClass.tail->next = slab;
+        } else {
+            sizeClass.head = slab;
+        }
+        sizeClass.tail = slab;
+    }
+
+    void unlinkAvailable(SizeClass& sizeClass, Slab* slab) {
+        if (slab->prev) slab->prev->next = slab->next; else sizeClass.head = slab->next;
+        if (slab->next) slab->next->prev = slab->prev; else sizeClass.tail = slab->prev;
+    }
+
+    // Matching thread: hand the top empty slab to the grower to unmap
+    void retire(SizeClass& sizeClass) {
+        Slab* slab = sizeClass.empty;
+        sizeClass.empty = slab->next;
+        if (slab->allPrev) slab->allPrev->allNext = slab->allNext; else allSlabs = slab->allNext;
+        if (slab->allNext) slab->allNext->allPrev = slab->allPrev;
+        uint32_t blocks = blocksPerSlab(slab->sizeClass);
+        sizeClass.freeBlocks -= blocks;
+        sizeClass.capacity.store(sizeClass.capacity.load(std::memory_order_relaxed) - blocks,
+                                 std::memory_order_relaxed);
+
+        Slab* head = retired.load(std::memory_order_relaxed);
+        do {
+            slab->next = head;
+        } while (!retired.compare_exchange_weak(head, slab, std::memory_order_release, std::memory_order_relaxed));
+    }
+
+    static Slab* mapSlab() {
+#ifdef __linux__
+        // Over-map and trim to a SLAB_BYTES-aligned window
+        void* p = ::mmap(nullptr, 2 * SLAB_BYTES, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (p == MAP_FAILED) {
+            return nullptr;
+        }
+        uintptr_t start = reinterpret_cast<uintptr_t>(p);
+        uintptr_t aligned = (start + SLAB_BYTES - 1) & ~uintptr_t(SLAB_BYTES - 1);
+        if (aligned > start) {
+            ::munmap(p, aligned - start);
+        }
+        if (aligned + SLAB_BYTES < start + 2 * SLAB_BYTES) {
+            ::munmap(reinterpret_cast<void*>(aligned + SLAB_BYTES), start + 2 * SLAB_BYTES - aligned - SLAB_BYTES);
+        }
+        return reinterpret_cast<Slab*>(aligned);
+#else
+        return static_cast<Slab*>(::operator new(SLAB_BYTES, std::align_val_t(SLAB_BYTES), std::nothrow));
+#endif
+    }
+
+    static void unmapSlab(Slab* slab) {
+#ifdef __linux__
+        ::munmap(slab, SLAB_BYTES);
+#else
+        ::operator delete(slab, std::align_val_t(SLAB_BYTES));
+#endif
+    }
+
+    // Touch every page so the matching thread takes no page faults on it
+    static void prefault(Slab* slab) {
+        volatile char* bytes = reinterpret_cast<volatile char*>(slab);
+        for (size_t offset = 0; offset < SLAB_BYTES; offset += 4096) {
+            bytes[offset] = 0;
+        }
+    }
+
+    void releaseAll() {
+        while (allSlabs) {
+            Slab* next = allSlabs->allNext;
+            unmapSlab(allSlabs);
+            allSlabs = next;
+        }
+        for (SizeClass& sizeClass : classes) {
+            Slab* spare = nullptr;
+            while (sizeClass.spares.tryPop(spare)) {
+                unmapSlab(spare);
+            }
+        }
+        Slab* slab = retired.exchange(nullptr);
+        while (slab) {
+            Slab* next = slab->next;
+            unmapSlab(slab);
+            slab = next;
+        }
+    }
+};
+
+// One background thread serving any number of pools. Registration is for
+// setup and teardown; the matching threads only touch their own pools'
+// atomics.
+class SlabGrower {
+private:
+    std::mutex registryLock;
+    std::vector<SlabPool*> pools;
+    std::thread thread;
+    std::atomic<bool> running{true};
+    const uint64_t releaseAfterMs;
+    const uint32_t pollUs;
+
+public:
+    explicit SlabGrower(uint64_t releaseAfter = 1000, uint32_t pollIntervalUs = 100)
+        : releaseAfterMs(releaseAfter), pollUs(pollIntervalUs) {
+        thread = std::thread([this] { run(); });
+    }
+
+    SlabGrower(const SlabGrower&) = delete;
+    SlabGrower& operator=(const SlabGrower&) = delete;
+
+    ~SlabGrower() {
+        running.store(false, std::memory_order_release);
+        thread.join();
+    }
+
+    void add(SlabPool* pool) {
+        std::lock_guard<std::mutex> guard(registryLock);
+        pools.push_back(pool);
+    }
+
+    void remove(SlabPool* pool) {
+        std::lock_guard<std::mutex> guard(registryLock);
+        for (size_t i = 0; i < pools.size(); ++i) {
+            if (pools[i] == pool) {
+                pools[i] = pools.back();
+                pools.pop_back();
+                break;
+            }
+        }
+    }
+
+private:
+    void run() {
+        auto start = std::chrono::steady_clock::now();
+        while (running.load(std::memory_order_acquire)) {
+            uint64_t nowMs = static_cast<uint64_t>(
+                std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start)
+                    .count()) + 1;
+            {
+                std::lock_guard<std::mutex> guard(registryLock);
+                for (SlabPool* pool : pools) {
+                    pool->service(nowMs, releaseAfterMs);
+                }
+            }
+            std::this_thread::sleep_for(std::chrono::microseconds(pollUs));
+        }
+    }
+};
+
+inline SlabPool::~SlabPool() {
+    setGrower(nullptr);
+    releaseAll();
+}
+
+inline void SlabPool::setGrower(SlabGrower* slabGrower) {
+    if (grower) {
+        grower->remove(this);
+    }
+    for (SizeClass& sizeClass : classes) {
+        sizeClass.shrinkRequested.store(false, std::memory_order_relaxed);
+        sizeClass.lowSinceMs = 0;
+    }
+    grower = slabGrower;
+    if (grower) {
+        grower->add(this);
+    }
+}
+
+// std allocator over a SlabPool; a null pool falls back to operator new
+template <typename T>
+class SlabAllocator {
+public:
+    using value_type = T;
+
+    SlabPool* pool;
+
+    explicit SlabAllocator(SlabPool* slabPool = nullptr) noexcept : pool(slabPool) {}
+
+    template <typename U>
+    SlabAllocator(const SlabAllocator<U>& other) noexcept : pool(other.pool) {}
+
+    T* allocate(size_t n) {
+        static_assert(alignof(T) <= SlabPool::GRANULE, "SlabPool blocks are 16-byte aligned");
+        size_t bytes = n * sizeof(T);
+        return static_cast<T*>(pool ? pool->allocate(bytes) : ::operator new(bytes));
+    }
+
+    void deallocate(T* p, size_t n) {
+        if (pool) {
+            pool->deallocate(p, n * sizeof(T));
+        } else {
+            ::operator delete(p);
+        }
+    }
+
+    template <typename U>
+    bool operator==(const SlabAllocator<U>& other) const { return pool == other.pool; }
+    template <typename U>
+    bool operator!=(const SlabAllocator<U>& other) const { return pool != other.pool; }
+};
+
+} // namespace HFT
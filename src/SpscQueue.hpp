@@ -0,0 +1,98 @@
+#pragma once
+
+#include <atomic>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace HFT {
+
+constexpr size_t CACHE_LINE_SIZE = 64;
+
+// Bounded lock-free single-producer / single-consumer ring. Capacity must
+// be a power of two. The producer can either copy in with tryPush() or
+// write in place with claim() + publish(); the consumer mirrors that with
+// tryPop() or front() + pop().
+template <typename T, size_t Capacity>
+class SpscQueue {
+    static_assert((Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+
+private:
+    static constexpr size_t MASK = Capacity - 1;
+
+    alignas(CACHE_LINE_SIZE) std::atomic<size_t> head{0};   // Next slot to read
+    size_t cachedTail = 0;                                  // Consumer's view of tail
+    alignas(CACHE_LINE_SIZE) std::atomic<size_t> tail{0};   // Next slot to write
+    size_t cachedHead = 0;                                  // Producer's view of head
+    alignas(CACHE_LINE_SIZE) std::array<T, Capacity> slots;
+
+public:
+    SpscQueue() = default;
+    SpscQueue(const SpscQueue&) = delete;
+    SpscQueue& operator=(const SpscQueue&) = delete;
+
+    // Producer: slot to fill in place, or nullptr if the ring is full
+    T* claim() {
+        size_t t = tail.load(std::memory_order_relaxed);
+        if (t - cachedHead == Capacity) {
+            cachedHead = head.load(std::memory_order_acquire);
+            if (t - cachedHead == Capacity) {
+                return nullptr;
+            }
+        }
+        return &slots[t & MASK];
+    }
+
+    // Producer: make the claimed slot visible to the consumer
+    void publish() {
+        tail.store(tail.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+    bool tryPush(const T& value) {
+        T* slot = claim();
+        if (!slot) {
+            return false;
+        }
+        *slot = value;
+        publish();
+        return true;
+    }
+
+    // Consumer: oldest element, or nullptr if the ring is empty
+    T* front() {
+        size_t h = head.load(std::memory_order_relaxed);
+        if (h == cachedTail) {
+            cachedTail = tail.load(std::memory_order_acquire);
+            if (h == cachedTail) {
+                return nullptr;
+            }
+        }
+        return &slots[h & MASK];
+    }
+
+    // Consumer: release the slot returned by front()
+    void pop() {
+        head.store(head.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+    bool tryPop(T& value) {
+        T* slot = front();
+        if (!slot) {
+            return false;
+        }
+        value = *slot;
+        pop();
+        return true;
+    }
+
+    // Approximate when called concurrently
+    size_t size() const {
+        return tail.load(std::memory_order_acquire) - head.load(std::memory_order_acquire);
+    }
+
+    bool empty() const { return size() == 0; }
+
+    static constexpr size_t capacity() { return Capacity; }
+};
+
+} // namespace HFT
@@ -0,0 +1,306 @@
+#pragma once
+
+// Shared-memory ticker plant: one seqlock-protected slot per instrument
+// holding the top TICKER_DEPTH levels of each side. The engine writes
+// slots straight from the book (see OrderBook::attachTickerPlant); any
+// local process maps the region read-only and copies quotes out with no
+// syscalls and no messaging.
+//
+//   TickerPlantHeader, then `instrumentCount` TickerSlots
+//
+// The layout is plain data plus lock-free atomics, so it is valid in every
+// process that maps it. Creating and mapping the region is POSIX (Linux);
+// the slot layout and publish path are portable.
+//
+// create never resizes or zeroes an object in place, since readers may
+// still have it mapped: it marks the old region retired, unlinks the name
+// and creates a new object. Old readers keep a valid (stale) mapping and
+// see isRetired(), their cue to reopen.
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <new>
+#include <string>
+
+#ifdef __linux__
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace HFT {
+
+constexpr uint32_t TICKER_DEPTH = 5;
+
+// Best TICKER_DEPTH levels per side, best first; unused levels are zero
+struct DepthQuote {
+    uint32_t bidPrice[TICKER_DEPTH];
+    uint32_t bidQuantity[TICKER_DEPTH];
+    uint32_t askPrice[TICKER_DEPTH];
+    uint32_t askQuantity[TICKER_DEPTH];
+    uint32_t bidLevels;
+    uint32_t askLevels;
+};
+
+struct alignas(64) TickerSlot {
+    std::atomic<uint64_t> sequence;   // Odd while a write is in progress
+    DepthQuote quote;
+};
+
+struct TickerPlantHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t depth;
+    uint32_t instrumentCount;
+    uint32_t slotSize;
+    std::atomic<uint32_t> retired;   // Set once the writer closed or replaced the region
+    uint8_t reserved[36];
+};
+
+static_assert(sizeof(TickerPlantHeader) == 64, "TickerPlantHeader layout");
+static_assert(std::atomic<uint64_t>::is_always_lock_free, "Seqlock counter must be address-free");
+static_assert(std::atomic<uint32_t>::is_always_lock_free, "Retired flag must be address-free");
+
+namespace TickerPlantFormat {
+constexpr char MAGIC[8] = {'H', 'F', 'T', 'T', 'I', 'C', 'K', '1'};
+constexpr uint32_t VERSION = 1;
+
+inline size_t regionSize(uint32_t instruments) {
+    return sizeof(TickerPlantHeader) + size_t(instruments) * sizeof(TickerSlot);
+}
+} // namespace TickerPlantFormat
+
+// Writer side, owned by the engine. One writer per slot (the book's
+// thread); publishes are wait-free.
+class TickerPlant {
+private:
+    void* base = nullptr;
+    size_t mappedSize = 0;
+    TickerSlot* slots = nullptr;
+    uint32_t instruments = 0;
+
+public:
+    TickerPlant() = default;
+    TickerPlant(const TickerPlant&) = delete;
+    TickerPlant& operator=(const TickerPlant&) = delete;
+    ~TickerPlant() { close(); }
+
+    // Create (or replace) the region `name` (e.g. "/hft_ticker") sized for
+    // `instrumentCount` slots, all empty. Any region this plant had mapped
+    // is closed first.
+    bool create(const std::string& name, uint32_t instrumentCount) {
+        close();
+#ifdef __linux__
+        // Retire and unlink the old object rather than truncate it under
+        // readers that still map it
+        int existing = ::shm_open(name.c_str(), O_RDWR, 0);
+        if (existing >= 0) {
+            retire(existing);
+            ::close(existing);
+            ::shm_unlink(name.c_str());
+        }
+        int fd = ::shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644);
+        if (fd < 0) {
+            return false;
+        }
+        size_t bytes = TickerPlantFormat::regionSize(instrumentCount);
+        bool ok = ::ftruncate(fd, static_cast<off_t>(bytes)) == 0;
+        void* p = ok ? ::mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0) : MAP_FAILED;
+        ::close(fd);
+        if (p == MAP_FAILED) {
+            ::shm_unlink(name.c_str());
+            return false;
+        }
+        base = p;
+        mappedSize = bytes;
+        instruments = instrumentCount;
+        slots = reinterpret_cast<TickerSlot*>(static_cast<char*>(base) + sizeof(TickerPlantHeader));
+        for (uint32_t i = 0; i < instruments; ++i) {
+            new (&slots[i]) TickerSlot();
+            slots[i].sequence.store(0, std::memory_order_relaxed);
+            std::memset(&slots[i].quote, 0, sizeof(DepthQuote));
+        }
+
+        // Header last: readers treat a missing magic as "not ready"
+        auto* header = static_cast<TickerPlantHeader*>(base);
+        header->version = TickerPlantFormat::VERSION;
+        header->depth = TICKER_DEPTH;
+        header->instrumentCount = instruments;
+        header->slotSize = sizeof(TickerSlot);
+        header->retired.store(0, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        std::memcpy(header->magic, TickerPlantFormat::MAGIC, sizeof(header->magic));
+        return true;
+#else
+        (void)name;
+        (void)instrumentCount;
+        return false;
+#endif
+    }
+
+    // Mark the region retired for its readers and unmap it; the name stays
+    void close() {
+#ifdef __linux__
+        if (base) {
+            static_cast<TickerPlantHeader*>(base)->retired.store(1, std::memory_order_release);
+            ::munmap(base, mappedSize);
+        }
+#endif
+        base = nullptr;
+        slots = nullptr;
+        mappedSize = 0;
+        instruments = 0;
+    }
+
+    // Remove the name; existing mappings stay valid
+    static void unlink(const std::string& name) {
+#ifdef __linux__
+        ::shm_unlink(name.c_str());
+#else
+        (void)name;
+#endif
+    }
+
+    uint32_t getInstrumentCount() const { return instruments; }
+
+    void publish(uint32_t instrumentId, const DepthQuote& quote) {
+        if (instrumentId >= instruments) {
+            return;
+        }
+        TickerSlot& slot = slots[instrumentId];
+        uint64_t seq = slot.sequence.load(std::memory_order_relaxed);
+        slot.sequence.store(seq + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        std::memcpy(&slot.quote, &quote, sizeof(DepthQuote));
+        slot.sequence.store(seq + 2, std::memory_order_release);
+    }
+
+private:
+#ifdef __linux__
+    // Flag an existing object's readers; skipped if it is not a region
+    static void retire(int fd) {
+        struct stat st;
+        if (::fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < sizeof(TickerPlantHeader)) {
+            return;
+        }
+        void* p = ::mmap(nullptr, sizeof(TickerPlantHeader), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        if (p == MAP_FAILED) {
+            return;
+        }
+        auto* header = static_cast<TickerPlantHeader*>(p);
+        if (std::memcmp(header->magic, TickerPlantFormat::MAGIC, sizeof(header->magic)) == 0) {
+            header->retired.store(1, std::memory_order_release);
+        }
+        ::munmap(p, sizeof(TickerPlantHeader));
+    }
+#endif
+};
+
+// Reader side: maps the region read-only
+class TickerReader {
+private:
+    const void* base = nullptr;
+    size_t mappedSize = 0;
+    const TickerSlot* slots = nullptr;
+    uint32_t instruments = 0;
+
+public:
+    TickerReader() = default;
+    TickerReader(const TickerReader&) = delete;
+    TickerReader& operator=(const TickerReader&) = delete;
+    ~TickerReader() { close(); }
+
+    // False if there is no ready region, or its writer already retired it
+    bool open(const std::string& name) {
+        close();
+#ifdef __linux__
+        int fd = ::shm_open(name.c_str(), O_RDONLY, 0);
+        if (fd < 0) {
+            return false;
+        }
+        struct stat st;
+        void* p = MAP_FAILED;
+        if (::fstat(fd, &st) == 0 && static_cast<size_t>(st.st_size) >= sizeof(TickerPlantHeader)) {
+            p = ::mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_SHARED, fd, 0);
+        }
+        ::close(fd);
+        if (p == MAP_FAILED) {
+            return false;
+        }
+        base = p;
+        mappedSize = static_cast<size_t>(st.st_size);
+
+        const auto* header = static_cast<const TickerPlantHeader*>(base);
+        if (std::memcmp(header->magic, TickerPlantFormat::MAGIC, sizeof(header->magic)) != 0 ||
+            header->depth != TICKER_DEPTH || header->slotSize != sizeof(TickerSlot) ||
+            TickerPlantFormat::regionSize(header->instrumentCount) > mappedSize ||
+            header->retired.load(std::memory_order_acquire) != 0) {
+            close();
+            return false;
+        }
+        std::atomic_thread_fence(std::memory_order_acquire);
+        instruments = header->instrumentCount;
+        slots = reinterpret_cast<const TickerSlot*>(static_cast<const char*>(base) + sizeof(TickerPlantHeader));
+        return true;
+#else
+        (void)name;
+        return false;
+#endif
+    }
+
+    void close() {
+#ifdef __linux__
+        if (base) {
+            ::munmap(const_cast<void*>(base), mappedSize);
+        }
+#endif
+        base = nullptr;
+        slots = nullptr;
+        mappedSize = 0;
+        instruments = 0;
+    }
+
+    uint32_t getInstrumentCount() const { return instruments; }
+
+    // True once the writer closed or replaced the region: quotes are stale
+    // and the name should be reopened
+    bool isRetired() const {
+        return static_cast<const TickerPlantHeader*>(base)->retired.load(std::memory_order_acquire) != 0;
+    }
+
+    // Single attempt; false if a write was in progress or raced the copy
+    bool tryRead(uint32_t instrumentId, DepthQuote& out) const {
+        const TickerSlot& slot = slots[instrumentId];
+        uint64_t before = slot.sequence.load(std::memory_order_acquire);
+        if (before & 1) {
+            return false;
+        }
+        std::memcpy(&out, &slot.quote, sizeof(DepthQuote));
+        std::atomic_thread_fence(std::memory_order_acquire);
+        return slot.sequence.load(std::memory_order_relaxed) == before;
+    }
+
+    // Retry until a consistent copy is taken; false only if the slot stays
+    // busy for `maxAttempts` (e.g. the writer died mid-update)
+    bool read(uint32_t instrumentId, DepthQuote& out, uint32_t maxAttempts = 1u << 20) const {
+        if (instrumentId >= instruments) {
+            return false;
+        }
+        for (uint32_t attempt = 0; attempt < maxAttempts; ++attempt) {
+            if (tryRead(instrumentId, out)) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Number of completed publishes to the slot; cheap change detection
+    uint64_t getUpdateCount(uint32_t instrumentId) const {
+        return slots[instrumentId].sequence.load(std::memory_order_acquire) / 2;
+    }
+};
+
+} // namespace HFT
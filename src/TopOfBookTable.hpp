@@ -0,0 +1,197 @@
+#pragma once
+
+// Structure-of-arrays top of book for every instrument in a manager, kept
+// current by the books themselves (see OrderBook::attachTopOfBook). Scans
+// run over whole columns: AVX2 when the build enables it, scalar otherwise.
+// An empty side has price 0 and never matches a two-sided filter.
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace HFT {
+
+struct TopOfBookQuote {
+    uint32_t bidPrice;
+    uint32_t bidQuantity;
+    uint32_t askPrice;
+    uint32_t askQuantity;
+
+    bool operator==(const TopOfBookQuote& other) const {
+        return bidPrice == other.bidPrice && bidQuantity == other.bidQuantity &&
+               askPrice == other.askPrice && askQuantity == other.askQuantity;
+    }
+    bool operator!=(const TopOfBookQuote& other) const { return !(*this == other); }
+};
+
+class TopOfBookTable {
+public:
+    // Columns are padded to this many lanes; padding slots stay empty
+    static constexpr size_t LANES = 8;
+
+private:
+    std::vector<uint32_t> bidPrice;
+    std::vector<uint32_t> askPrice;
+    std::vector<uint32_t> bidQuantity;
+    std::vector<uint32_t> askQuantity;
+    size_t instruments = 0;
+
+public:
+    void resize(size_t count) {
+        instruments = count;
+        size_t padded = (count + LANES - 1) / LANES * LANES;
+        bidPrice.resize(padded, 0);
+        askPrice.resize(padded, 0);
+        bidQuantity.resize(padded, 0);
+        askQuantity.resize(padded, 0);
+    }
+
+    size_t size() const { return instruments; }
+
+    void update(uint32_t instrumentId, const TopOfBookQuote& quote) {
+        bidPrice[instrumentId] = quote.bidPrice;
+        bidQuantity[instrumentId] = quote.bidQuantity;
+        askPrice[instrumentId] = quote.askPrice;
+        askQuantity[instrumentId] = quote.askQuantity;
+    }
+
+    uint32_t getBidPrice(uint32_t instrumentId) const { return bidPrice[instrumentId]; }
+    uint32_t getAskPrice(uint32_t instrumentId) const { return askPrice[instrumentId]; }
+    uint32_t getBidQuantity(uint32_t instrumentId) const { return bidQuantity[instrumentId]; }
+    uint32_t getAskQuantity(uint32_t instrumentId) const { return askQuantity[instrumentId]; }
+
+    // Instruments quoted on both sides with ask - bid > minTicks. Prices
+    // must fit in 31 bits (compared as signed lanes).
+    size_t findWideSpreads(uint32_t minTicks, std::vector<uint32_t>& out) const {
+#if defined(__AVX2__)
+        return findWideSpreadsAvx2(minTicks, out);
+#else
+        return findWideSpreadsScalar(minTicks, out);
+#endif
+    }
+
+    // Instruments quoted on both sides with bid >= ask
+    size_t findLockedOrCrossed(std::vector<uint32_t>& out) const {
+#if defined(__AVX2__)
+        return findLockedOrCrossedAvx2(out);
+#else
+        return findLockedOrCrossedScalar(out);
+#endif
+    }
+
+    // Instruments missing a bid, an ask, or both
+    size_t findOneSided(std::vector<uint32_t>& out) const {
+#if defined(__AVX2__)
+        return findOneSidedAvx2(out);
+#else
+        return findOneSidedScalar(out);
+#endif
+    }
+
+    // Scalar kernels, always available (reference and fallback)
+    size_t findWideSpreadsScalar(uint32_t minTicks, std::vector<uint32_t>& out) const {
+        out.clear();
+        for (size_t i = 0; i < instruments; ++i) {
+            if (bidPrice[i] != 0 && askPrice[i] != 0 &&
+                static_cast<int32_t>(askPrice[i] - bidPrice[i]) > static_cast<int32_t>(minTicks)) {
+                out.push_back(static_cast<uint32_t>(i));
+            }
+        }
+        return out.size();
+    }
+
+    size_t findLockedOrCrossedScalar(std::vector<uint32_t>& out) const {
+        out.clear();
+        for (size_t i = 0; i < instruments; ++i) {
+            if (bidPrice[i] != 0 && askPrice[i] != 0 && bidPrice[i] >= askPrice[i]) {
+                out.push_back(static_cast<uint32_t>(i));
+            }
+        }
+        return out.size();
+    }
+
+    size_t findOneSidedScalar(std::vector<uint32_t>& out) const {
+        out.clear();
+        for (size_t i = 0; i < instruments; ++i) {
+            if (bidPrice[i] == 0 || askPrice[i] == 0) {
+                out.push_back(static_cast<uint32_t>(i));
+            }
+        }
+        return out.size();
+    }
+
+#if defined(__AVX2__)
+    size_t findWideSpreadsAvx2(uint32_t minTicks, std::vector<uint32_t>& out) const {
+        const __m256i threshold = _mm256_set1_epi32(static_cast<int32_t>(minTicks));
+        return scanAvx2(out, [&](__m256i bid, __m256i ask) {
+            __m256i spread = _mm256_sub_epi32(ask, bid);
+            return _mm256_and_si256(twoSided(bid, ask), _mm256_cmpgt_epi32(spread, threshold));
+        });
+    }
+
+    size_t findLockedOrCrossedAvx2(std::vector<uint32_t>& out) const {
+        return scanAvx2(out, [&](__m256i bid, __m256i ask) {
+            // bid >= ask  <=>  !(ask > bid)
+            return _mm256_andnot_si256(_mm256_cmpgt_epi32(ask, bid), twoSided(bid, ask));
+        });
+    }
+
+    size_t findOneSidedAvx2(std::vector<uint32_t>& out) const {
+        const __m256i zero = _mm256_setzero_si256();
+        return scanAvx2(out, [&](__m256i bid, __m256i ask) {
+            return _mm256_or_si256(_mm256_cmpeq_epi32(bid, zero), _mm256_cmpeq_epi32(ask, zero));
+        }, true);
+    }
+#endif
+
+private:
+    static unsigned lowestBit(uint32_t mask) {
+#if defined(_MSC_VER)
+        unsigned long index;
+        _BitScanForward(&index, mask);
+        return static_cast<unsigned>(index);
+#else
+        return static_cast<unsigned>(__builtin_ctz(mask));
+#endif
+    }
+
+#if defined(__AVX2__)
+    static __m256i twoSided(__m256i bid, __m256i ask) {
+        const __m256i zero = _mm256_setzero_si256();
+        __m256i empty = _mm256_or_si256(_mm256_cmpeq_epi32(bid, zero), _mm256_cmpeq_epi32(ask, zero));
+        return _mm256_xor_si256(empty, _mm256_set1_epi32(-1));
+    }
+
+    // Eight instruments per step; `predicate` returns an all-ones lane for
+    // each match. Padding lanes are empty, so only filters that match empty
+    // books need `clipPadding`.
+    template <typename Predicate>
+    size_t scanAvx2(std::vector<uint32_t>& out, Predicate&& predicate, bool clipPadding = false) const {
+        out.clear();
+        const size_t padded = bidPrice.size();
+        for (size_t i = 0; i < padded; i += LANES) {
+            __m256i bid = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(bidPrice.data() + i));
+            __m256i ask = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(askPrice.data() + i));
+            uint32_t mask = static_cast<uint32_t>(_mm256_movemask_ps(_mm256_castsi256_ps(predicate(bid, ask))));
+            while (mask != 0) {
+                uint32_t id = static_cast<uint32_t>(i + lowestBit(mask));
+                if (clipPadding && id >= instruments) {
+                    break;
+                }
+                out.push_back(id);
+                mask &= mask - 1;
+            }
+        }
+        return out.size();
+    }
+#endif
+};
+
+} // namespace HFT
@@ -0,0 +1,205 @@
+#pragma once
+
+// Sampled end-to-end message tracing. One message in `sampleEvery` is given
+// a trace slot at receive; the slot index rides along in Command and
+// CommandResponse (0 = untraced), and each pipeline stage stamps the TSC
+// into it. When the response is sent the slot is folded into per-stage
+// histograms and recycled.
+//
+// Unsampled messages pay one countdown at receive and a `traceSlot != 0`
+// test per stage. Slots are allocated, completed and recycled on the
+// gateway thread; the sequencer and shard stamp them in between, ordered
+// by the rings the command travels through.
+
+#include "Tsc.hpp"
+#include <array>
+#include <cassert>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace HFT {
+
+enum class TraceStage : uint8_t {
+    RECEIVE = 0,
+    DECODE = 1,
+    SEQUENCE = 2,
+    MATCH_START = 3,
+    MATCH_END = 4,
+    ENCODE = 5,
+    SEND = 6
+};
+
+constexpr size_t TRACE_STAGES = 7;
+
+inline const char* traceStageName(size_t stage) {
+    static const char* const names[TRACE_STAGES] = {
+        "receive", "decode", "sequence", "match start", "match end", "encode", "send"};
+    return stage < TRACE_STAGES ? names[stage] : "?";
+}
+
+// Receive TSC plus 32-bit cycle offsets for the later stages; an offset of
+// 0 means the stage was not stamped (e.g. no sequencer in the pipeline)
+struct alignas(32) TraceRecord {
+    uint64_t receiveTsc;
+    uint32_t offset[TRACE_STAGES - 1];
+};
+
+static_assert(sizeof(TraceRecord) == 32, "TraceRecord layout");
+
+// Log-linear histogram of cycle counts: exact below 16, then 8 buckets per
+// power of two (at most 12.5% relative error)
+class LatencyHistogram {
+public:
+    static constexpr size_t BUCKETS = 16 + 60 * 8;
+
+private:
+    std::array<uint64_t, BUCKETS> counts{};
+    uint64_t total = 0;
+
+    static unsigned highestBit(uint64_t v) {
+        unsigned bit = 0;
+        while (v >>= 1) {
+            ++bit;
+        }
+        return bit;
+    }
+
+public:
+    static size_t bucketOf(uint64_t value) {
+        if (value < 16) {
+            return static_cast<size_t>(value);
+        }
+        unsigned msb = highestBit(value);
+        return 16 + (msb - 4) * 8 + static_cast<size_t>((value >> (msb - 3)) & 7);
+    }
+
+    // Largest value that falls into `bucket`
+    static uint64_t bucketUpperBound(size_t bucket) {
+        if (bucket < 16) {
+            return bucket;
+        }
+        unsigned msb = static_cast<unsigned>((bucket - 16) / 8 + 4);
+        uint64_t sub = (bucket - 16) % 8;
+        return ((8 + sub + 1) << (msb - 3)) - 1;
+    }
+
+    void record(uint64_t value) {
+        ++counts[bucketOf(value)];
+        ++total;
+    }
+
+    uint64_t count() const { return total; }
+
+    // Upper bound of the bucket holding the `p` quantile (0..1)
+    uint64_t percentile(double p) const {
+        if (total == 0) {
+            return 0;
+        }
+        uint64_t rank = static_cast<uint64_t>(p * static_cast<double>(total - 1)) + 1;
+        uint64_t seen = 0;
+        for (size_t b = 0; b < BUCKETS; ++b) {
+            seen += counts[b];
+            if (seen >= rank) {
+                return bucketUpperBound(b);
+            }
+        }
+        return bucketUpperBound(BUCKETS - 1);
+    }
+
+    void reset() {
+        counts.fill(0);
+        total = 0;
+    }
+};
+
+class MessageTracer {
+private:
+    std::unique_ptr<TraceRecord[]> records;
+    std::vector<uint32_t> freeSlots;
+    uint32_t sampleEvery;
+    uint32_t countdown;
+
+    // stageHistograms[s] holds the time from the previous stamped stage to s
+    std::array<LatencyHistogram, TRACE_STAGES> stageHistograms;
+    LatencyHistogram endToEnd;
+    uint64_t completed = 0;
+    uint64_t skipped = 0;       // Sample due but every slot in flight
+
+public:
+    // Trace one message in `every`, with up to `slots` traces in flight
+    explicit MessageTracer(uint32_t every = 1024, uint32_t slots = 4096)
+        : records(new TraceRecord[slots + 1]()), sampleEvery(every ? every : 1), countdown(sampleEvery) {
+        // Slot 0 is the "untraced" marker and is never handed out
+        freeSlots.reserve(slots);
+        for (uint32_t s = slots; s >= 1; --s) {
+            freeSlots.push_back(s);
+        }
+    }
+
+    MessageTracer(const MessageTracer&) = delete;
+    MessageTracer& operator=(const MessageTracer&) = delete;
+
+    // Gateway thread, per received message: a slot if this message is
+    // sampled, else 0. `receiveTsc` is the TSC read when its bytes arrived.
+    uint32_t sample(uint64_t receiveTsc) {
+        if (--countdown != 0) {
+            return 0;
+        }
+        countdown = sampleEvery;
+        if (freeSlots.empty()) {
+            ++skipped;
+            return 0;
+        }
+        uint32_t slot = freeSlots.back();
+        freeSlots.pop_back();
+        TraceRecord& record = records[slot];
+        record = TraceRecord{};
+        record.receiveTsc = receiveTsc;
+        return slot;
+    }
+
+    // Any stage thread; callers test the slot first so untraced messages
+    // never read the clock. RECEIVE is set by sample(), never stamped.
+    void stamp(uint32_t slot, TraceStage stage) {
+        assert(stage != TraceStage::RECEIVE);
+        if (stage == TraceStage::RECEIVE) {
+            return;
+        }
+        TraceRecord& record = records[slot];
+        uint64_t elapsed = readTsc() - record.receiveTsc;
+        uint32_t offset = elapsed >= UINT32_MAX ? UINT32_MAX : static_cast<uint32_t>(elapsed);
+        record.offset[static_cast<size_t>(stage) - 1] = offset ? offset : 1;
+    }
+
+    // Gateway thread, after the response left: fold into the histograms
+    // and recycle the slot
+    void complete(uint32_t slot) {
+        const TraceRecord& record = records[slot];
+        uint32_t previous = 0;
+        for (size_t s = 1; s < TRACE_STAGES; ++s) {
+            uint32_t offset = record.offset[s - 1];
+            if (offset == 0) {
+                continue;
+            }
+            stageHistograms[s].record(offset >= previous ? offset - previous : 0);
+            previous = offset;
+        }
+        endToEnd.record(previous);
+        ++completed;
+        freeSlots.push_back(slot);
+    }
+
+    // Gateway thread: the message will never be sent (session gone)
+    void abandon(uint32_t slot) { freeSlots.push_back(slot); }
+
+    const LatencyHistogram& getStageHistogram(TraceStage stage) const {
+        return stageHistograms[static_cast<size_t>(stage)];
+    }
+    const LatencyHistogram& getEndToEndHistogram() const { return endToEnd; }
+    uint64_t getCompletedCount() const { return completed; }
+    uint64_t getSkippedCount() const { return skipped; }
+    uint32_t getSampleEvery() const { return sampleEvery; }
+};
+
+} // namespace HFT
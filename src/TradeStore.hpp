@@ -0,0 +1,340 @@
+#pragma once
+
+// Append-only, memory-mapped trade store with a sparse time index (POSIX).
+//
+//   <path>      TradeStoreHeader, then raw Trade records in append order
+//   <path>.idx  one uint64 per block: timestamp of the block's first trade
+//
+// Trades must be appended in non-decreasing timestamp order, which holds
+// for trades taken from a book fed in sequence.
+
+#include "BlockCompression.hpp"
+#include "MappedFile.hpp"
+#include "Order.hpp"
+#include "SpscQueue.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace HFT {
+
+struct TradeStoreHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t blockRecords;
+    uint64_t recordCount;
+    uint8_t reserved[40];
+};
+
+static_assert(sizeof(TradeStoreHeader) == 64, "TradeStoreHeader layout");
+static_assert(sizeof(Trade) == 32, "Trade record layout");
+
+namespace TradeStoreFormat {
+constexpr char MAGIC[8] = {'H', 'F', 'T', 'T', 'R', 'D', 'S', '1'};
+constexpr char ARCHIVE_MAGIC[8] = {'H', 'F', 'T', 'T', 'R', 'D', 'Z', '1'};
+constexpr uint32_t VERSION = 1;
+} // namespace TradeStoreFormat
+
+// Writer side; owned by the I/O thread
+class TradeStoreWriter {
+private:
+    MappedFile dataFile;
+    MappedFile indexFile;
+    uint32_t blockRecords = 0;
+    uint64_t count = 0;
+
+public:
+    bool open(const std::string& path, uint32_t recordsPerBlock = 1024) {
+        if (!dataFile.open(path, true) || !indexFile.open(path + ".idx", true)) {
+            return false;
+        }
+
+        if (dataFile.size() >= sizeof(TradeStoreHeader) &&
+            std::memcmp(header()->magic, TradeStoreFormat::MAGIC, sizeof(TradeStoreFormat::MAGIC)) == 0) {
+            // Existing store: keep appending
+            blockRecords = header()->blockRecords;
+            count = header()->recordCount;
+            return true;
+        }
+
+        blockRecords = recordsPerBlock;
+        count = 0;
+        if (!dataFile.reserve(sizeof(TradeStoreHeader))) {
+            return false;
+        }
+        TradeStoreHeader* h = header();
+        std::memset(h, 0, sizeof(*h));
+        std::memcpy(h->magic, TradeStoreFormat::MAGIC, sizeof(h->magic));
+        h->version = TradeStoreFormat::VERSION;
+        h->blockRecords = blockRecords;
+        return true;
+    }
+
+    bool append(const Trade& trade) {
+        size_t needed = sizeof(TradeStoreHeader) + (count + 1) * sizeof(Trade);
+        if (!dataFile.reserve(needed)) {
+            return false;
+        }
+        if (count % blockRecords == 0) {
+            uint64_t block = count / blockRecords;
+            if (!indexFile.reserve((block + 1) * sizeof(uint64_t), 1 << 20)) {
+                return false;
+            }
+            reinterpret_cast<uint64_t*>(indexFile.data())[block] = trade.timestamp;
+        }
+        std::memcpy(dataFile.data() + sizeof(TradeStoreHeader) + count * sizeof(Trade), &trade, sizeof(Trade));
+        ++count;
+        header()->recordCount = count;
+        return true;
+    }
+
+    // Trim preallocated space and unmap
+    void close() {
+        if (!dataFile.isOpen()) {
+            return;
+        }
+        uint64_t blocks = (count + blockRecords - 1) / blockRecords;
+        dataFile.truncate(sizeof(TradeStoreHeader) + count * sizeof(Trade));
+        indexFile.truncate(blocks * sizeof(uint64_t));
+        dataFile.close();
+        indexFile.close();
+    }
+
+    ~TradeStoreWriter() { close(); }
+
+    uint64_t size() const { return count; }
+
+private:
+    TradeStoreHeader* header() { return reinterpret_cast<TradeStoreHeader*>(dataFile.data()); }
+};
+
+// Contiguous run of trades inside the mapping; valid while the reader is open
+struct TradeRange {
+    const Trade* first;
+    const Trade* last;
+
+    const Trade* begin() const { return first; }
+    const Trade* end() const { return last; }
+    size_t size() const { return static_cast<size_t>(last - first); }
+    bool empty() const { return first == last; }
+};
+
+// Reader side: maps the store read-only and answers time-range queries by
+// binary-searching the block index, then the block itself
+class TradeStoreReader {
+private:
+    MappedFile dataFile;
+    MappedFile indexFile;
+    const Trade* trades = nullptr;
+    const uint64_t* index = nullptr;
+    uint64_t count = 0;
+    uint64_t blocks = 0;
+    uint32_t blockRecords = 1;
+
+public:
+    bool open(const std::string& path) {
+        if (!dataFile.open(path, false) || !indexFile.open(path + ".idx", false)) {
+            return false;
+        }
+        return load();
+    }
+
+    // Pick up trades appended since open() (or the last refresh)
+    bool refresh() {
+        return dataFile.refresh() && indexFile.refresh() && load();
+    }
+
+    uint64_t size() const { return count; }
+
+    TradeRange all() const { return {trades, trades + count}; }
+
+    // All trades with fromTs <= timestamp < toTs, in place
+    TradeRange query(uint64_t fromTs, uint64_t toTs) const {
+        if (fromTs >= toTs) {
+            return {trades, trades};
+        }
+        return {lowerBound(fromTs), lowerBound(toTs)};
+    }
+
+    template <typename Fn>
+    size_t forEachInRange(uint64_t fromTs, uint64_t toTs, Fn&& fn) const {
+        TradeRange range = query(fromTs, toTs);
+        for (const Trade& trade : range) {
+            fn(trade);
+        }
+        return range.size();
+    }
+
+private:
+    bool load() {
+        if (dataFile.size() < sizeof(TradeStoreHeader)) {
+            return false;
+        }
+        const auto* h = reinterpret_cast<const TradeStoreHeader*>(dataFile.data());
+        if (std::memcmp(h->magic, TradeStoreFormat::MAGIC, sizeof(TradeStoreFormat::MAGIC)) != 0) {
+            return false;
+        }
+        blockRecords = h->blockRecords;
+        trades = reinterpret_cast<const Trade*>(dataFile.data() + sizeof(TradeStoreHeader));
+        index = reinterpret_cast<const uint64_t*>(indexFile.data());
+
+        // Only trust what is fully mapped in both files
+        uint64_t mappedRecords = (dataFile.size() - sizeof(TradeStoreHeader)) / sizeof(Trade);
+        count = std::min<uint64_t>(h->recordCount, mappedRecords);
+        blocks = std::min<uint64_t>((count + blockRecords - 1) / blockRecords,
+                                    indexFile.size() / sizeof(uint64_t));
+        count = std::min<uint64_t>(count, blocks * blockRecords);
+        return true;
+    }
+
+    // First trade with timestamp >= ts
+    const Trade* lowerBound(uint64_t ts) const {
+        if (blocks == 0) {
+            return trades;
+        }
+        // First block starting at or after ts; the answer lies in the block
+        // before it or at its first record
+        uint64_t block = static_cast<uint64_t>(std::lower_bound(index, index + blocks, ts) - index);
+        uint64_t lo = block == 0 ? 0 : (block - 1) * blockRecords;
+        uint64_t hi = std::min<uint64_t>(count, block * blockRecords);
+        return std::lower_bound(trades + lo, trades + hi, ts,
+            [](const Trade& trade, uint64_t t) { return trade.timestamp < t; });
+    }
+};
+
+// Compressed archive of a finished store: blocks keyed by their first
+// timestamp, so range queries decode only the blocks they overlap.
+// Returns the archive size in bytes, or 0 on failure.
+inline uint64_t archiveTradeStore(const TradeStoreReader& store, const std::string& path,
+                                  uint32_t recordsPerBlock = 4096) {
+    CompressedBlockWriter writer;
+    if (!writer.open(path, TradeStoreFormat::ARCHIVE_MAGIC, sizeof(Trade), recordsPerBlock)) {
+        return 0;
+    }
+    for (const Trade& trade : store.all()) {
+        writer.append(&trade, trade.timestamp);
+    }
+    writer.close();
+    return writer.getBytesWritten();
+}
+
+class TradeArchiveReader {
+private:
+    CompressedBlockReader blocks;
+
+public:
+    bool open(const std::string& path) {
+        return blocks.open(path, TradeStoreFormat::ARCHIVE_MAGIC) && blocks.getRecordSize() == sizeof(Trade);
+    }
+
+    uint64_t size() const { return blocks.getRecordCount(); }
+
+    // Same semantics as TradeStoreReader::forEachInRange
+    template <typename Fn>
+    size_t forEachInRange(uint64_t fromTs, uint64_t toTs, Fn&& fn) {
+        size_t visited = 0;
+        size_t first = blocks.lowerBoundKey(fromTs);
+        for (size_t b = first == 0 ? 0 : first - 1; b < blocks.getBlockCount(); ++b) {
+            if (blocks.getBlock(b).firstKey >= toTs) {
+                break;
+            }
+            const auto* trades = reinterpret_cast<const Trade*>(blocks.readBlock(b));
+            if (!trades) {
+                break;
+            }
+            const Trade* end = trades + blocks.getBlock(b).records;
+            const Trade* it = std::lower_bound(trades, end, fromTs,
+                [](const Trade& trade, uint64_t t) { return trade.timestamp < t; });
+            for (; it != end && it->timestamp < toTs; ++it) {
+                fn(*it);
+                ++visited;
+            }
+        }
+        return visited;
+    }
+};
+
+// Buffered hand-off from the matching thread to an I/O thread that owns the
+// TradeStoreWriter. The engine only touches an SPSC ring and never waits:
+// publishNew() leaves anything that did not fit in the book's own trade
+// vector and picks it up on the next call.
+class AsyncTradeRecorder {
+public:
+    using TradeQueue = SpscQueue<Trade, 65536>;
+
+private:
+    TradeStoreWriter writer;
+    std::unique_ptr<TradeQueue> ring = std::make_unique<TradeQueue>();
+    std::thread ioThread;
+    std::atomic<bool> running{false};
+    size_t cursor = 0;
+
+public:
+    AsyncTradeRecorder() = default;
+    AsyncTradeRecorder(const AsyncTradeRecorder&) = delete;
+    AsyncTradeRecorder& operator=(const AsyncTradeRecorder&) = delete;
+    ~AsyncTradeRecorder() { stop(); }
+
+    bool start(const std::string& path, uint32_t recordsPerBlock = 1024) {
+        if (!writer.open(path, recordsPerBlock)) {
+            return false;
+        }
+        running.store(true, std::memory_order_release);
+        ioThread = std::thread([this] { ioLoop(); });
+        return true;
+    }
+
+    // Engine side: hand off trades appended to `trades` since the last call.
+    // Returns how many were handed off.
+    size_t publishNew(const std::vector<Trade>& trades) {
+        size_t published = 0;
+        while (cursor < trades.size() && ring->tryPush(trades[cursor])) {
+            ++cursor;
+            ++published;
+        }
+        return published;
+    }
+
+    // Engine side: single trade; false if the ring is full
+    bool publish(const Trade& trade) { return ring->tryPush(trade); }
+
+    // Call when the engine clears its trade vector
+    void resetCursor() { cursor = 0; }
+
+    // Drain the ring, trim and close the store
+    void stop() {
+        if (!running.exchange(false)) {
+            return;
+        }
+        ioThread.join();
+        writer.close();
+    }
+
+    uint64_t getRecordCount() const { return writer.size(); }
+
+private:
+    void ioLoop() {
+        for (;;) {
+            bool stopping = !running.load(std::memory_order_acquire);
+            size_t drained = 0;
+            while (const Trade* trade = ring->front()) {
+                writer.append(*trade);
+                ring->pop();
+                ++drained;
+            }
+            if (drained == 0) {
+                if (stopping) {
+                    return;
+                }
+                std::this_thread::sleep_for(std::chrono::microseconds(50));
+            }
+        }
+    }
+};
+
+} // namespace HFT
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <thread>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#elif defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+namespace HFT {
+
+// Raw cycle counter for hot-path timestamps. Falls back to steady_clock
+// nanoseconds on targets without a TSC.
+inline uint64_t readTsc() {
+#if defined(_MSC_VER) || defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+#endif
+}
+
+// Wall-clock nanoseconds since the epoch, for pairing with readTsc()
+inline uint64_t wallClockNs() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count());
+}
+
+// TSC ticks per nanosecond, measured against steady_clock over `sampleMs`.
+// For converting traced cycle counts; 1.0 where readTsc() is already ns.
+inline double measureTscTicksPerNs(int sampleMs = 20) {
+    auto wallStart = std::chrono::steady_clock::now();
+    uint64_t tscStart = readTsc();
+    std::this_thread::sleep_for(std::chrono::milliseconds(sampleMs));
+    uint64_t tscEnd = readTsc();
+    auto wallNs = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - wallStart).count();
+    return wallNs > 0 ? static_cast<double>(tscEnd - tscStart) / static_cast<double>(wallNs) : 1.0;
+}
+
+} // namespace HFT
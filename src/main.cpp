@@ -1,4 +1,5 @@
 #include "OrderBook.hpp"
+#include "Logger.hpp"
 #include <iostream>
 #include <chrono>
 
@@ -35,6 +36,7 @@ void demonstrateOrderBook() {
     
     std::cout << "\nTrades executed:\n";
     for (const auto& trade : book.getTrades()) {
+        HFT_LOG("trade buy={} sell={} px={} qty={}", trade.buyOrderId, trade.sellOrderId, trade.price, trade.quantity);
         std::cout << "  Buy Order #" << trade.buyOrderId 
                   << " x Sell Order #" << trade.sellOrderId
                   << " | Price: " << trade.price 
@@ -49,10 +51,20 @@ void demonstrateOrderBook() {
     book.printBook(5);
     
     std::cout << "\n4. Adding aggressive sell order...\n";
+    book.enableSweepSummaries(true);
     book.addOrder(10047, 250, OrderSide::SELL, getCurrentTimestamp());
     
     book.printBook(5);
     
+    std::cout << "\nSweep summary (one record per price level):\n";
+    for (const auto& sweep : book.getSweepSummaries()) {
+        std::cout << "  Aggressor #" << sweep.aggressorOrderId
+                  << " | Price: " << sweep.price
+                  << " | Qty: " << sweep.totalQuantity
+                  << " | Counterparties: " << sweep.counterpartyCount
+                  << " (#" << sweep.firstRestingOrderId << " .. #" << sweep.lastRestingOrderId << ")\n";
+    }
+    
     std::cout << "\n=== Statistics ===\n";
     std::cout << "Best Bid: " << book.getBestBid() << "\n";
     std::cout << "Best Ask: " << book.getBestAsk() << "\n";
@@ -80,6 +92,8 @@ void performanceTest() {
     auto end = high_resolution_clock::now();
     auto duration = duration_cast<nanoseconds>(end - start).count();
     
+    HFT_LOG("performance test: {} orders in {} ns, {} trades", NUM_ORDERS, duration, book.getTrades().size());
+    
     std::cout << "Added " << NUM_ORDERS << " orders\n";
     std::cout << "Total time: " << duration / 1000.0 << " microseconds\n";
     std::cout << "Average latency per order: " << duration / NUM_ORDERS << " nanoseconds\n";
@@ -87,8 +101,13 @@ void performanceTest() {
 }
 
 int main() {
+    // Engine diagnostics go to a binary log; render with orderbook_logdecode
+    Logger::instance().start("orderbook_demo.binlog");
+    
     demonstrateOrderBook();
     performanceTest();
     
+    Logger::instance().stop();
+    
     return 0;
 }
@@ -0,0 +1,184 @@
+#include "../src/Logger.hpp"
+#include <cinttypes>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+using namespace HFT;
+
+// Offline renderer for binary logs written by HFT::Logger
+
+namespace {
+
+// Bounds-checked cursor; a short read marks the log as truncated
+struct Reader {
+    const std::vector<char>& data;
+    size_t pos = 0;
+    bool truncated = false;
+
+    bool has(size_t n) const { return !truncated && pos + n <= data.size(); }
+
+    template <typename T>
+    T read() {
+        T value{};
+        if (!has(sizeof(T))) {
+            truncated = true;
+            return value;
+        }
+        std::memcpy(&value, data.data() + pos, sizeof(T));
+        pos += sizeof(T);
+        return value;
+    }
+
+    std::string readString() {
+        uint32_t len = read<uint32_t>();
+        if (!has(len)) {
+            truncated = true;
+            return {};
+        }
+        std::string str(data.data() + pos, len);
+        pos += len;
+        return str;
+    }
+};
+
+struct Calibration {
+    uint64_t tsc;
+    uint64_t ns;
+};
+
+std::string renderArg(LogArgType type, uint64_t bits, const std::string& str) {
+    char buf[64];
+    switch (type) {
+    case LogArgType::I64:
+        std::snprintf(buf, sizeof(buf), "%" PRId64, static_cast<int64_t>(bits));
+        return buf;
+    case LogArgType::U64:
+        std::snprintf(buf, sizeof(buf), "%" PRIu64, bits);
+        return buf;
+    case LogArgType::F64: {
+        double d;
+        std::memcpy(&d, &bits, sizeof(d));
+        std::snprintf(buf, sizeof(buf), "%g", d);
+        return buf;
+    }
+    case LogArgType::CHAR:
+        return std::string(1, static_cast<char>(bits));
+    case LogArgType::STR:
+        return str;
+    default:
+        return "?";
+    }
+}
+
+std::string renderFormat(const std::string& format, const std::vector<std::string>& args) {
+    std::string out;
+    size_t next = 0;
+    for (size_t i = 0; i < format.size(); ++i) {
+        if (format[i] == '{' && i + 1 < format.size() && format[i + 1] == '}') {
+            out += next < args.size() ? args[next++] : "{}";
+            ++i;
+        } else {
+            out += format[i];
+        }
+    }
+    return out;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        std::cerr << "Usage: " << argv[0] << " <binary log file>\n";
+        return 1;
+    }
+
+    std::ifstream in(argv[1], std::ios::binary);
+    if (!in) {
+        std::cerr << "Cannot open " << argv[1] << "\n";
+        return 1;
+    }
+    std::vector<char> data((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+
+    if (data.size() < sizeof(BinaryLog::MAGIC) ||
+        std::memcmp(data.data(), BinaryLog::MAGIC, sizeof(BinaryLog::MAGIC)) != 0) {
+        std::cerr << "Not a binary log: " << argv[1] << "\n";
+        return 1;
+    }
+
+    // Parse everything first: the closing calibration record is needed to
+    // convert TSC timestamps to wall-clock time
+    std::vector<Calibration> calibrations;
+    std::unordered_map<uint32_t, std::string> formats;
+    Reader reader{data, sizeof(BinaryLog::MAGIC)};
+    struct Entry {
+        uint32_t formatId;
+        uint64_t tsc;
+        std::vector<std::string> args;
+    };
+    std::vector<Entry> entries;
+
+    while (reader.has(1)) {
+        uint8_t tag = reader.read<uint8_t>();
+        if (tag == BinaryLog::TAG_FORMAT) {
+            uint32_t id = reader.read<uint32_t>();
+            uint32_t line = reader.read<uint32_t>();
+            std::string file = reader.readString();
+            std::string format = reader.readString();
+            (void)line;
+            (void)file;
+            if (!reader.truncated) {
+                formats[id] = format;
+            }
+        } else if (tag == BinaryLog::TAG_ENTRY) {
+            Entry entry;
+            entry.formatId = reader.read<uint32_t>();
+            entry.tsc = reader.read<uint64_t>();
+            uint8_t count = reader.read<uint8_t>();
+            for (uint8_t i = 0; i < count; ++i) {
+                LogArgType type = reader.read<LogArgType>();
+                if (type == LogArgType::STR) {
+                    entry.args.push_back(reader.readString());
+                } else {
+                    entry.args.push_back(renderArg(type, reader.read<uint64_t>(), ""));
+                }
+            }
+            if (!reader.truncated) {
+                entries.push_back(std::move(entry));
+            }
+        } else if (tag == BinaryLog::TAG_CALIBRATE) {
+            uint64_t tsc = reader.read<uint64_t>();
+            uint64_t ns = reader.read<uint64_t>();
+            if (!reader.truncated) {
+                calibrations.push_back({tsc, ns});
+            }
+        } else {
+            std::cerr << "Corrupt record at offset " << reader.pos - 1 << "\n";
+            return 1;
+        }
+    }
+    if (reader.truncated) {
+        std::cerr << "Warning: log is truncated; trailing partial record ignored\n";
+    }
+
+    double nsPerTick = 1.0;
+    if (calibrations.size() >= 2 && calibrations.back().tsc > calibrations.front().tsc) {
+        nsPerTick = static_cast<double>(calibrations.back().ns - calibrations.front().ns) /
+                    static_cast<double>(calibrations.back().tsc - calibrations.front().tsc);
+    }
+    Calibration base = calibrations.empty() ? Calibration{0, 0} : calibrations.front();
+
+    for (const auto& entry : entries) {
+        double offsetNs = (static_cast<double>(entry.tsc) - static_cast<double>(base.tsc)) * nsPerTick;
+        uint64_t ns = base.ns + static_cast<int64_t>(offsetNs);
+        auto it = formats.find(entry.formatId);
+        std::string text = (it != formats.end()) ? renderFormat(it->second, entry.args) : "<unknown format>";
+        std::printf("%" PRIu64 ".%09" PRIu64 " %s\n", ns / 1000000000, ns % 1000000000, text.c_str());
+    }
+
+    return 0;
+}